@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_logger.h"
+#include "ame_memory.h"
+#include "ame_predicate.h"
+#include "ame_process.h"
+#include "ame_stats.h"
+#include "ame_string.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <charconv>
+#include <fstream>
+#include <functional>
+#include <print>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using namespace ame;
+
+// Needles planted in the target, one of each type per stride.
+constexpr std::int32_t needleInt = 0x2A5F3C71;
+constexpr std::int64_t needleLong = 0x6B1D49E207C3A58FLL;
+constexpr float needleFloat = 1234.5678F;
+constexpr double needleDouble = 98765.4321;
+constexpr std::string_view needleText = "AmeBenchNeedle42";
+constexpr std::size_t needleBytes = 32 + needleText.size(); // of all needles of a stride
+
+constexpr std::size_t maxBssBytes = std::size_t{64} << 20;
+std::byte bssBlock[maxBssBytes]; // stays untouched (and unbacked) in the bench itself
+
+struct Options {
+    std::size_t heapBytes = std::size_t{64} << 20;
+    std::size_t anonBytes = std::size_t{256} << 20;
+    std::size_t bssBytes = std::size_t{16} << 20;
+    std::size_t stride = 4096; // bytes between needles of the same type, at least needleBytes
+    std::uint64_t seed = 20250101;
+    int repeat = 3;
+    std::string output = "bench_result.json";
+    bool isHelp = false;
+};
+
+struct Target {
+    pid_t pid = -1;
+};
+
+std::uint64_t NextRandom(std::uint64_t &state) noexcept {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+/**
+ * @brief Fill with seeded random values, then plant one needle of each type every stride bytes.
+ */
+void FillRegion(std::span<std::byte> region, std::size_t stride, std::uint64_t seed) {
+    std::uint64_t state = seed | 1;
+    for (std::size_t i = 0; i + sizeof(std::uint64_t) <= region.size(); i += sizeof(std::uint64_t)) {
+        const std::uint64_t value = NextRandom(state);
+        std::memcpy(&region[i], &value, sizeof(value));
+    }
+    for (std::size_t i = 0; i + needleBytes <= region.size(); i += stride) {
+        std::memcpy(&region[i], &needleInt, sizeof(needleInt));
+        std::memcpy(&region[i + 8], &needleLong, sizeof(needleLong));
+        std::memcpy(&region[i + 16], &needleFloat, sizeof(needleFloat));
+        std::memcpy(&region[i + 24], &needleDouble, sizeof(needleDouble));
+        std::memcpy(&region[i + 32], needleText.data(), needleText.size());
+    }
+}
+
+[[noreturn]] void RunTarget(const Options &options, int readyFd) {
+    auto *heap = static_cast<std::byte *>(sbrk(intptr_t(options.heapBytes)));
+    if (heap == reinterpret_cast<std::byte *>(-1)) {
+        _exit(1);
+    }
+    void *anon = mmap(nullptr, options.anonBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (anon == MAP_FAILED) {
+        _exit(1);
+    }
+    FillRegion({heap, options.heapBytes}, options.stride, options.seed);
+    FillRegion({static_cast<std::byte *>(anon), options.anonBytes}, options.stride, options.seed + 1);
+    FillRegion({bssBlock, options.bssBytes}, options.stride, options.seed + 2);
+
+    const char ready = 1;
+    if (write(readyFd, &ready, 1) != 1) {
+        _exit(1);
+    }
+    while (true) {
+        pause(); // killed by the bench
+    }
+}
+
+Target SpawnTarget(const Options &options) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+        std::println(stderr, "pipe: {}", std::strerror(errno));
+        return {};
+    }
+    const pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        RunTarget(options, fds[1]);
+    }
+    close(fds[1]);
+    char ready = 0;
+    const bool isReady = (pid > 0) && (read(fds[0], &ready, 1) == 1);
+    close(fds[0]);
+    if (!isReady) {
+        std::println(stderr, "Failed to start target process.");
+        return {};
+    }
+    return {pid};
+}
+
+void KillTarget(const Target &target) {
+    kill(target.pid, SIGKILL);
+    waitpid(target.pid, nullptr, 0);
+}
+
+struct Result {
+    std::string name;
+    std::uint64_t wallNs = 0;
+    std::uint64_t hitCount = 0;
+    ScanStats stats;
+};
+
+/**
+ * @brief Run func options.repeat times and keep the fastest run.
+ * @param [in] func  Returns the hit count.
+ */
+Result Measure(const Options &options, std::string name, const std::function<std::size_t()> &func) {
+    Result best{std::move(name)};
+    for (int i = 0; i < options.repeat; ++i) {
+        Result result{best.name};
+        {
+            const ScanStatsScope scope{result.stats};
+            PhaseTimer timer;
+            result.hitCount = func();
+            result.wallNs = timer.Lap();
+        }
+        if ((i == 0) || (result.wallNs < best.wallNs)) {
+            best = std::move(result);
+        }
+    }
+
+    const ScanCounters &counters = best.stats.counters;
+    const double gbPerSec = double(counters.bytesRead + counters.bytesWritten) / double(best.wallNs);
+    const double nsPerHit = best.hitCount ? double(best.wallNs) / double(best.hitCount) : 0.0;
+    std::println("{:<40} {:>10.3f} ms {:>8.3f} GB/s {:>10} syscalls {:>10} hits {:>10.1f} ns/hit", best.name, double(best.wallNs) / 1e6, gbPerSec,
+                 counters.syscallCount, best.hitCount, nsPerHit);
+    return best;
+}
+
+template <Arithmetic T>
+void BenchType(const Options &options, const Target &target, std::string_view typeName, T needle, std::vector<Result> &results) {
+    const pid_t pid = target.pid;
+    AddrList hits;
+
+    results.push_back(Measure(options, std::format("FindAddress<{}>/ALL", typeName), [&] {
+        hits = FindAddress(pid, MemPart::ALL, needle);
+        return hits.size();
+    }));
+    results.push_back(Measure(options, std::format("FindAddress<{}>/C_HEAP", typeName), [&] {
+        return FindAddress(pid, MemPart::C_HEAP, needle).size();
+    }));
+    results.push_back(Measure(options, std::format("FindAddressByRange<{}>/ALL", typeName), [&] {
+        return FindAddressByRange(pid, MemPart::ALL, T(needle - 1), T(needle + 1)).size();
+    }));
+    results.push_back(Measure(options, std::format("FindArrayAddress<{}>/ALL", typeName), [&] {
+        return FindArrayAddress(pid, MemPart::ALL, std::vector<T>{needle}).size();
+    }));
+    results.push_back(Measure(options, std::format("FilterAddrList<{}>", typeName), [&] {
+        return FilterAddrList(pid, hits, needle).size();
+    }));
+    results.push_back(Measure(options, std::format("FilterAddrListByRange<{}>", typeName), [&] {
+        return FilterAddrListByRange(pid, hits, T(needle - 1), T(needle + 1)).size();
+    }));
+    results.push_back(Measure(options, std::format("FilterAddrListByOffset<{}>", typeName), [&] {
+        return FilterAddrListByOffset(pid, hits, needle, std::int64_t(options.stride)).size();
+    }));
+    // Write the needles back, so the target stays the same.
+    results.push_back(Measure(options, std::format("WriteAddressGroup<{}>", typeName), [&] {
+        return std::size_t(WriteAddressGroup(pid, hits, needle, hits.size()));
+    }));
+    results.push_back(Measure(options, std::format("WriteArrayAddress<{}>", typeName), [&] {
+        return std::size_t(WriteArrayAddress(pid, hits, std::vector<T>{needle}));
+    }));
+}
+
+/**
+ * @brief Predicates on int32 that match the needles, to compare with FindAddress<int32>/ALL.
+ *
+ * The range is (value >= needle) && (value <= needle), built at compile time (expr) and compiled from text (kernel).
+ */
+void BenchPredicate(const Options &options, const Target &target, std::vector<Result> &results) {
+    using predicate::value;
+    const pid_t pid = target.pid;
+
+    results.push_back(Measure(options, "FindAddressIf<int32>/ALL expr ==", [&] {
+        return FindAddressIf<std::int32_t>(pid, MemPart::ALL, value == needleInt).size();
+    }));
+    results.push_back(Measure(options, "FindAddressIf<int32>/ALL expr range", [&] {
+        return FindAddressIf<std::int32_t>(pid, MemPart::ALL, (value >= needleInt) && (value <= needleInt)).size();
+    }));
+    const auto kernel = CompilePredicate<std::int32_t>(std::format("(value >= {0}) && (value <= {0})", needleInt));
+    if (kernel.has_value()) {
+        results.push_back(Measure(options, "FindAddressIf<int32>/ALL kernel range", [&] {
+            return FindAddressIf<std::int32_t>(pid, MemPart::ALL, *kernel).size();
+        }));
+    }
+}
+
+/**
+ * @brief String searches, to compare with FindAddress<int32>/ALL; the needle is only planted in UTF-8.
+ */
+void BenchString(const Options &options, const Target &target, std::vector<Result> &results) {
+    const pid_t pid = target.pid;
+
+    results.push_back(Measure(options, "FindStringAddress<UTF8>/ALL", [&] {
+        return FindStringAddress(pid, MemPart::ALL, needleText).size();
+    }));
+    results.push_back(Measure(options, "FindStringAddress<UTF8>/ALL ignoreCase", [&] {
+        return FindStringAddress(pid, MemPart::ALL, needleText, StringEncoding::UTF8, true).size();
+    }));
+    results.push_back(Measure(options, "FindStringAddress<UTF16LE>/ALL", [&] {
+        return FindStringAddress(pid, MemPart::ALL, needleText, StringEncoding::UTF16LE).size();
+    }));
+}
+
+void WriteResults(const Options &options, const std::vector<Result> &results) {
+    std::ofstream file{options.output};
+    if (!file.is_open()) {
+        std::println(stderr, "Failed to open [{}].", options.output);
+        return;
+    }
+    std::println(file, R"({{"heapBytes":{},"anonBytes":{},"bssBytes":{},"stride":{},"seed":{},"threads":{},"results":[)", options.heapBytes, options.anonBytes,
+                 options.bssBytes, options.stride, options.seed, ThreadPool::Instance().ThreadCount() + 1);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+        ScanStats stats = result.stats;
+        stats.regions.clear(); // keep the file small
+        std::println(file, R"({{"name":"{}","wallNs":{},"hitCount":{},"stats":{}}}{})", result.name, result.wallNs, result.hitCount, stats.ToJson(),
+                     (i + 1 < results.size()) ? "," : "");
+    }
+    std::println(file, "]}}");
+    std::println("Results written to [{}].", options.output);
+}
+
+bool ParseSize(std::string_view str, std::size_t &value) {
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), value);
+    return (ec == std::errc{}) && (ptr == str.data() + str.size());
+}
+
+void PrintUsage(std::FILE *stream, const char *program) {
+    std::println(stream, "Usage: {} [--heap-mb=N] [--anon-mb=N] [--bss-mb=N (<= 64)] [--stride=BYTES] [--seed=N] [--repeat=N] [--output=FILE]", program);
+}
+
+
+bool ParseOptions(int argc, char *argv[], Options &options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg{argv[i]};
+        if ((arg == "--help") || (arg == "-h")) {
+            PrintUsage(stdout, argv[0]);
+            options.isHelp = true;
+            return true;
+        }
+        const auto equalPos = arg.find('=');
+        const std::string_view key = arg.substr(0, equalPos);
+        const std::string_view value = (equalPos == std::string_view::npos) ? "" : arg.substr(equalPos + 1);
+        std::size_t number = 0;
+        bool isValid = ParseSize(value, number);
+        if (key == "--heap-mb") {
+            options.heapBytes = number << 20;
+        } else if (key == "--anon-mb") {
+            options.anonBytes = number << 20;
+        } else if (key == "--bss-mb") {
+            options.bssBytes = number << 20;
+            isValid &= (options.bssBytes <= maxBssBytes);
+        } else if (key == "--stride") {
+            options.stride = number;
+            isValid &= (number >= needleBytes) && (number % 8 == 0);
+        } else if (key == "--seed") {
+            options.seed = number;
+        } else if (key == "--repeat") {
+            options.repeat = int(number);
+            isValid &= (number > 0);
+        } else if (key == "--output") {
+            options.output = value;
+            isValid = !value.empty();
+        } else {
+            isValid = false;
+        }
+        if (!isValid) {
+            std::println(stderr, "Invalid option '{}'.", arg);
+            PrintUsage(stderr, argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (options.isHelp) {
+        return 0;
+    }
+    Logger::Instance().SetLevel(LogLevel::WARN);
+
+    const Target target = SpawnTarget(options);
+    if (target.pid == -1) {
+        return 1;
+    }
+    std::println("Target {}: heap {} MiB, anon {} MiB, bss {} MiB, stride {} B, {} threads", target.pid, options.heapBytes >> 20, options.anonBytes >> 20,
+                 options.bssBytes >> 20, options.stride, ThreadPool::Instance().ThreadCount() + 1);
+
+    std::vector<Result> results;
+    BenchType(options, target, "int32", needleInt, results);
+    BenchType(options, target, "int64", needleLong, results);
+    BenchType(options, target, "float", needleFloat, results);
+    BenchType(options, target, "double", needleDouble, results);
+    BenchPredicate(options, target, results);
+    BenchString(options, target, results);
+
+    // Two targets at once, on the shared thread pool.
+    const Target secondTarget = SpawnTarget(options);
+    if (secondTarget.pid != -1) {
+        results.push_back(Measure(options, "FindAddress<int32>/ALL x2 processes", [&] {
+            std::size_t hitCount = 0;
+            for (const auto &[pid, addrList] : FindAddress(PidList{target.pid, secondTarget.pid}, MemPart::ALL, needleInt)) {
+                hitCount += addrList.size();
+            }
+            return hitCount;
+        }));
+        KillTarget(secondTarget);
+    }
+
+    results.push_back(Measure(options, "FreezeProcessByPid+ResumeProcessByPid", [&] {
+        return std::size_t(FreezeProcessByPid(target.pid)) + std::size_t(ResumeProcessByPid(target.pid));
+    }));
+
+    KillTarget(target);
+    WriteResults(options, results);
+    return 0;
+}
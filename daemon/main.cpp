@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_daemon.h"
+#include "ame_logger.h"
+
+#include <csignal>
+
+#include <print>
+#include <string>
+
+namespace {
+
+ame::Daemon *runningDaemon = nullptr;
+
+void HandleSignal(int) {
+    if (runningDaemon) {
+        runningDaemon->Stop();
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    using namespace ame;
+
+    const std::string socketPath = (argc > 1) ? argv[1] : "/data/local/tmp/ame.sock";
+    std::println("Socket path: '{}'", socketPath);
+
+    Logger::Instance().SetAsync(true);
+    Daemon daemon{socketPath};
+    runningDaemon = &daemon;
+    std::signal(SIGINT, &HandleSignal);
+    std::signal(SIGTERM, &HandleSignal);
+    const bool isOk = daemon.Run();
+    runningDaemon = nullptr;
+    return isOk ? 0 : 1;
+}
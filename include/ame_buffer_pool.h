@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_BUFFER_POOL_H
+#define AME_BUFFER_POOL_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief Blocks of memory for read buffers and results, reused across scans, within a global budget.
+ *
+ * Blocks are blockSize bytes and aligned to it, so the kernel can back them with huge pages. Read buffers of at most
+ * bufferSize bytes and result chunks of chunkSize bytes are cut from such blocks (slabs), so that neither takes a whole
+ * block.
+ */
+class BufferPool {
+public:
+    static constexpr std::size_t blockSize = std::size_t{2} << 20; // a huge page with 4 KiB pages
+    static constexpr std::size_t bufferSize = blockSize / 2;
+    static constexpr std::size_t chunkSize = std::size_t{64} << 10;
+    static constexpr std::size_t defaultCacheSize = std::size_t{64} << 20; // free blocks kept without budget
+
+    /**
+     * @brief A block taken from the pool, given back on destruction.
+     */
+    class Block {
+    public:
+        Block() noexcept = default;
+
+        Block(Block &&other) noexcept
+            : _pool{std::exchange(other._pool, nullptr)}, _data{std::exchange(other._data, nullptr)}, _size{std::exchange(other._size, 0)},
+              _isTransient{other._isTransient} {}
+
+        Block &operator=(Block &&other) noexcept {
+            if (this != &other) {
+                Reset();
+                _pool = std::exchange(other._pool, nullptr);
+                _data = std::exchange(other._data, nullptr);
+                _size = std::exchange(other._size, 0);
+                _isTransient = other._isTransient;
+            }
+            return *this;
+        }
+
+        ~Block() {
+            Reset();
+        }
+
+        [[nodiscard]] std::byte *Data() const noexcept {
+            return _data;
+        }
+
+        [[nodiscard]] std::size_t Size() const noexcept {
+            return _size;
+        }
+
+        [[nodiscard]] explicit operator bool() const noexcept {
+            return _data != nullptr;
+        }
+
+        void Reset() noexcept {
+            if (_data) {
+                _pool->Release(_data, _size, _isTransient);
+                _data = nullptr;
+            }
+        }
+
+    protected:
+        friend class BufferPool;
+
+        Block(BufferPool *pool, std::byte *data, std::size_t size, bool isTransient) noexcept
+            : _pool{pool}, _data{data}, _size{size}, _isTransient{isTransient} {}
+
+        BufferPool *_pool = nullptr;
+        std::byte *_data = nullptr;
+        std::size_t _size = 0;
+        bool _isTransient = false;
+    };
+
+    [[nodiscard, gnu::visibility("default")]] static BufferPool &Instance() {
+        static BufferPool pool;
+        return pool;
+    }
+
+    BufferPool() = default;
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    ~BufferPool();
+
+    /**
+     * @brief Set the bytes of blocks that may be in use at once by all scans, 0 for no limit (default).
+     *
+     * Read buffers wait while the budget is reached, which throttles parallel scans. The budget bounds the memory of
+     * the pool, not of a scan: once it is reached, results go on in plain vectors (see AddrChunkList), as do the
+     * results returned to the caller. ScanControl::maxResults bounds those.
+     */
+    void SetBudget(std::size_t budget);
+
+    [[nodiscard]] std::size_t Budget() const;
+
+    [[nodiscard]] std::size_t UsedBytes() const;
+
+    [[nodiscard]] std::size_t CachedBytes() const;
+
+    /**
+     * @brief Take a block of at least size bytes for a buffer that is given back soon, e.g. to read a scan task.
+     *
+     * Waits while the budget is reached and another such block is in use. A size up to bufferSize gets bufferSize
+     * bytes; a larger one whole blocks, and one over blockSize a block of its own, which is freed rather than kept.
+     */
+    [[nodiscard]] Block Acquire(std::size_t size);
+
+    /**
+     * @brief Take a chunk of chunkSize bytes to keep results, without waiting.
+     * @return The chunk, or an empty Block if the budget is reached.
+     */
+    [[nodiscard]] Block TryAcquireChunk();
+
+    /**
+     * @brief Free the blocks kept for reuse, and the slabs if no buffer or chunk cut from them is in use.
+     */
+    void Trim();
+
+protected:
+    std::byte *Take(std::size_t size);
+    std::byte *TakePiece(std::vector<std::byte *> &freePieces, std::size_t pieceSize);
+    void Release(std::byte *data, std::size_t size, bool isTransient);
+    void FreeSlabs();
+
+    mutable std::mutex _mutex;
+    std::condition_variable _releaseCond;
+    std::vector<std::byte *> _freeBlocks;
+    std::vector<std::byte *> _freeBuffers;
+    std::vector<std::byte *> _freeChunks;
+    std::vector<std::byte *> _slabs;
+    std::size_t _pieceBytes = 0;     // of buffers and chunks out of the pool
+    std::size_t _budget = 0;
+    std::size_t _usedBytes = 0;      // of blocks out of the pool
+    std::size_t _transientBytes = 0; // of blocks from Acquire
+};
+
+
+/**
+ * @brief Addresses appended in chunks of pool blocks, so a growing result never reallocates or copies.
+ *
+ * The first inlineCapacity addresses are held in place, so a task with few matches takes no chunk, and so are the
+ * handles of the first inlineChunkCount chunks, so one with more matches allocates nothing but chunks. When the pool is
+ * out of budget, later addresses spill to a plain vector, which the budget does not count.
+ */
+class AddrChunkList {
+public:
+    static constexpr std::size_t inlineCapacity = 32;
+    static constexpr std::size_t chunkCapacity = BufferPool::chunkSize / sizeof(std::uint64_t);
+    static constexpr std::size_t inlineChunkCount = 4;
+
+    AddrChunkList() = default;
+
+    AddrChunkList(const AddrChunkList &) = delete;
+    AddrChunkList &operator=(const AddrChunkList &) = delete;
+
+    void PushBack(std::uint64_t address) {
+        if ((_cursor == _chunkEnd) && !Grow()) [[unlikely]] {
+            _spill.push_back(address);
+            return;
+        }
+        *_cursor++ = address;
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept {
+        return ChunkedSize() + _spill.size();
+    }
+
+    /**
+     * @brief Keep the first size addresses.
+     */
+    void Truncate(std::size_t size);
+
+    void AppendTo(std::vector<std::uint64_t> &addrList) const;
+
+protected:
+    bool Grow();
+
+    [[nodiscard]] std::uint64_t *ChunkBegin(std::size_t index) const noexcept {
+        const BufferPool::Block &chunk = (index < inlineChunkCount) ? _inlineChunks[index] : _moreChunks[index - inlineChunkCount];
+        return reinterpret_cast<std::uint64_t *>(chunk.Data());
+    }
+
+    [[nodiscard]] std::size_t ChunkedSize() const noexcept {
+        if (_chunkCount == 0) {
+            return _cursor - _inlineAddrs.data();
+        }
+        return inlineCapacity + (_chunkCount - 1) * chunkCapacity + (_cursor - ChunkBegin(_chunkCount - 1));
+    }
+
+    std::array<std::uint64_t, inlineCapacity> _inlineAddrs;
+    std::array<BufferPool::Block, inlineChunkCount> _inlineChunks;
+    std::vector<BufferPool::Block> _moreChunks;
+    std::size_t _chunkCount = 0;
+    std::vector<std::uint64_t> _spill;
+    std::uint64_t *_cursor = _inlineAddrs.data(); // in the last chunk, or in _inlineAddrs before the first
+    std::uint64_t *_chunkEnd = _inlineAddrs.data() + inlineCapacity;
+    bool _isSpilled = false;
+};
+
+} // namespace ame
+
+#endif // AME_BUFFER_POOL_H
@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_CONTROL_H
+#define AME_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <vector>
+
+namespace ame {
+
+enum class MemPart;
+
+/**
+ * @brief Order in which the regions of a scan are read.
+ */
+enum class RegionOrder : std::uint8_t {
+    ADDRESS,        // by process, then address
+    SMALLEST_FIRST, // by size of the region
+    PART_PRIORITY,  // regions of ScanControl::partPriority first, in that order, then by address
+};
+
+/**
+ * @brief Why a scan ended before all regions were read.
+ */
+enum class ScanStopReason : std::uint8_t {
+    NONE, // complete
+    CANCELLED,
+    TIME_BUDGET,
+    BYTE_BUDGET,
+    MAX_RESULTS,
+};
+
+/**
+ * @brief Limits, order and progress of Find* and Filter* calls.
+ *
+ * Applies to every such call made on the thread while a ScanControlScope for it exists. A scan that stops early
+ * returns the addresses found so far, which are still sorted. Limits are checked between tasks (scanChunkSize bytes
+ * or filterChunkSize addresses), and each call starts its budgets anew.
+ */
+struct ScanControl {
+    std::stop_token stopToken;                  // e.g. of a std::stop_source the UI thread holds
+    std::chrono::milliseconds timeBudget{0};    // 0 for no limit
+    std::uint64_t byteBudget = 0;               // bytes to read, 0 for no limit
+    std::size_t maxResults = 0;                 // 0 for no limit; the addresses of the first tasks in order are kept
+    RegionOrder regionOrder = RegionOrder::ADDRESS;
+    std::vector<MemPart> partPriority;          // for RegionOrder::PART_PRIORITY
+    std::chrono::milliseconds progressInterval{100};
+
+    /**
+     * @brief void(std::uint64_t doneBytes, std::uint64_t totalBytes), called at most once per progressInterval from
+     * any thread of the scan, one call at a time, and once more at the end.
+     */
+    std::function<void(std::uint64_t, std::uint64_t)> progress;
+
+    // Outcome of the last call.
+    ScanStopReason stopReason = ScanStopReason::NONE;
+    std::uint64_t doneBytes = 0;
+    std::uint64_t totalBytes = 0;
+
+    /**
+     * @return The ScanControl of the innermost ScanControlScope on this thread, or nullptr.
+     */
+    [[nodiscard]] static ScanControl *Current() noexcept;
+};
+
+/**
+ * @brief Let the Find* and Filter* calls on this thread follow CONTROL during the lifetime of the scope.
+ */
+class ScanControlScope {
+public:
+    explicit ScanControlScope(ScanControl &control) noexcept;
+
+    ScanControlScope(const ScanControlScope &) = delete;
+    ScanControlScope &operator=(const ScanControlScope &) = delete;
+
+    ~ScanControlScope();
+
+protected:
+    ScanControl *_previous;
+};
+
+/**
+ * @brief Apply a ScanControl to the tasks of one call, from the worker threads.
+ *
+ * Without a ScanControl, every task runs.
+ */
+class ScanLimiter {
+public:
+    explicit ScanLimiter(ScanControl *control) noexcept;
+
+    void SetTotalBytes(std::uint64_t totalBytes) noexcept;
+
+    /**
+     * @return Whether to run a task of bytes, or skip it because the scan is stopping.
+     */
+    [[nodiscard]] bool BeginTask(std::uint64_t bytes) noexcept;
+
+    void EndTask(std::uint64_t bytes, std::size_t matchCount);
+
+    [[nodiscard]] std::size_t MaxResults() const noexcept {
+        return _control ? _control->maxResults : 0;
+    }
+
+    /**
+     * @brief End the scan early for reason, unless it is stopping for another reason already.
+     */
+    void Stop(ScanStopReason reason) noexcept;
+
+    /**
+     * @brief Report the outcome to the ScanControl, on the calling thread after all tasks.
+     */
+    void Finish();
+
+protected:
+
+    ScanControl *_control;
+    std::chrono::steady_clock::time_point _deadline;
+    std::atomic<ScanStopReason> _stopReason = ScanStopReason::NONE;
+    std::atomic_uint64_t _startedBytes = 0;
+    std::atomic_uint64_t _doneBytes = 0;
+    std::atomic_size_t _matchCount = 0;
+    std::uint64_t _totalBytes = 0;
+    std::mutex _progressMutex;
+    std::chrono::steady_clock::time_point _lastProgress;
+};
+
+} // namespace ame
+
+#endif // AME_CONTROL_H
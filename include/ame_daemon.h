@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_DAEMON_H
+#define AME_DAEMON_H
+
+#include "ame_memory.h"
+#include "ame_process.h"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief Commands of the daemon protocol.
+ *
+ * A request is a frame of {uint32 size, uint8 command, payload}, a response is one or more frames of
+ * {uint32 size, uint8 status, payload}, where size counts the status/command byte and the payload. Fields follow each
+ * other without padding. Integers are in native byte order, since both ends run on the same device. A string is
+ * {uint32 length, char bytes[length]}, without a terminating 0. type is a ValueType, memPart a MemPart and mode a
+ * MatchMode; value and maxValue hold a value of type in their low bytes (see EncodeValue).
+ */
+enum class DaemonCommand : std::uint8_t {
+    ATTACH = 1,    // {uint8 byName = 1, string name} or {uint8 byName = 0, uint32 count, int32 pids[count]} -> {uint32 session, uint32 pidCount}
+    DETACH,        // {uint32 session} -> {}
+    SCAN,          // {uint32 session, uint8 type, uint8 memPart, uint8 mode, uint64 value, uint64 maxValue} -> {uint64 count}
+    FILTER,        // {uint32 session, uint8 type, uint8 mode, int64 offset, uint64 value, uint64 maxValue} -> {uint64 count}
+    RESULTS,       // {uint32 session, uint64 maxCount} -> MORE {uint32 n, {int32 pid, uint64 address}[n]}..., OK {uint64 count}
+    WRITE,         // {uint32 session, uint8 type, uint64 value} -> {uint64 successCount}
+    LOCK,          // {uint32 session, uint8 type, uint64 value, uint32 intervalMs} -> {uint64 addressCount}
+    UNLOCK,        // {uint32 session} -> {}
+    FREEZE,        // {uint32 session} -> {uint64 successCount}
+    RESUME,        // {uint32 session} -> {uint64 successCount}
+    SNAPSHOT_SAVE, // {uint32 session, uint8 slot} -> {uint64 count}
+    SNAPSHOT_LOAD, // {uint32 session, uint8 slot} -> {uint64 count}
+};
+
+enum class DaemonStatus : std::uint8_t {
+    OK,
+    MORE,  // a part of a streamed result, more frames follow
+    ERROR, // {string message}
+};
+
+enum class ValueType : std::uint8_t {
+    INT8,
+    INT16,
+    INT32,
+    INT64,
+    FLOAT,
+    DOUBLE,
+    UINT8,
+    UINT16,
+    UINT32,
+    UINT64,
+};
+
+enum class MatchMode : std::uint8_t {
+    EQUAL, // *address == value
+    RANGE, // value <= *address <= maxValue
+};
+
+/**
+ * @brief Call func(T{}) with the type T of a ValueType.
+ * @return Whether type is valid.
+ */
+template <typename Func>
+bool VisitValueType(ValueType type, Func &&func) {
+    switch (type) {
+        case ValueType::INT8:
+            func(std::int8_t{});
+            return true;
+        case ValueType::INT16:
+            func(std::int16_t{});
+            return true;
+        case ValueType::INT32:
+            func(std::int32_t{});
+            return true;
+        case ValueType::INT64:
+            func(std::int64_t{});
+            return true;
+        case ValueType::FLOAT:
+            func(float{});
+            return true;
+        case ValueType::DOUBLE:
+            func(double{});
+            return true;
+        case ValueType::UINT8:
+            func(std::uint8_t{});
+            return true;
+        case ValueType::UINT16:
+            func(std::uint16_t{});
+            return true;
+        case ValueType::UINT32:
+            func(std::uint32_t{});
+            return true;
+        case ValueType::UINT64:
+            func(std::uint64_t{});
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Value of any ValueType, in the low bytes of 8 bytes.
+ */
+template <Arithmetic T>
+[[nodiscard]] std::uint64_t EncodeValue(T value) noexcept {
+    static_assert(sizeof(T) <= sizeof(std::uint64_t), "no ValueType for T");
+    std::uint64_t raw = 0;
+    std::memcpy(&raw, &value, sizeof(T));
+    return raw;
+}
+
+template <Arithmetic T>
+[[nodiscard]] T DecodeValue(std::uint64_t raw) noexcept {
+    static_assert(sizeof(T) <= sizeof(std::uint64_t), "no ValueType for T");
+    T value;
+    std::memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Builder of a frame payload.
+ */
+class MessageWriter {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    MessageWriter &Put(T value) {
+        _data.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        return *this;
+    }
+
+    MessageWriter &PutString(std::string_view str) {
+        Put(std::uint32_t(str.size()));
+        _data += str;
+        return *this;
+    }
+
+    [[nodiscard]] const std::string &Data() const noexcept {
+        return _data;
+    }
+
+protected:
+    std::string _data;
+};
+
+/**
+ * @brief Parser of a frame payload; every Get fails once the payload is exhausted.
+ */
+class MessageReader {
+public:
+    explicit MessageReader(std::string_view data) noexcept
+        : _data{data} {}
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool Get(T &value) noexcept {
+        if (_data.size() - _pos < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, _data.data() + _pos, sizeof(T));
+        _pos += sizeof(T);
+        return true;
+    }
+
+    bool GetString(std::string &str) {
+        std::uint32_t size;
+        if (!Get(size) || (_data.size() - _pos < size)) {
+            return false;
+        }
+        str.assign(_data.substr(_pos, size));
+        _pos += size;
+        return true;
+    }
+
+protected:
+    std::string_view _data;
+    std::size_t _pos = 0;
+};
+
+/**
+ * @brief Long-lived server that keeps sessions (target processes, result sets, snapshots, value locks) warm
+ * between commands sent over a Unix domain socket.
+ */
+class Daemon {
+public:
+    explicit Daemon(std::string socketPath);
+
+    Daemon(const Daemon &) = delete;
+    Daemon &operator=(const Daemon &) = delete;
+
+    ~Daemon();
+
+    /**
+     * @brief Accept and serve clients, one thread each, until Stop() is called.
+     *
+     * The socket is only accessible by the owner, and clients of another user are turned away. Failures to accept a
+     * client, e.g. with all file descriptors in use, are logged and retried.
+     * @return Whether it ran until Stop(), rather than failing to set up or use the socket.
+     */
+    bool Run();
+
+    /**
+     * @brief Make Run() return. Async-signal-safe.
+     */
+    void Stop() noexcept;
+
+protected:
+    struct Session {
+        std::mutex mutex;
+        PidList pids;
+        std::vector<FileWrapper> memFiles; // of pids, opened by ATTACH for every SCAN and FILTER; regions are reread
+        PidAddrMap results;
+        std::map<std::uint8_t, PidAddrMap> snapshots;
+        std::jthread lockThread;
+    };
+
+    void ServeClient(int clientFd);
+    bool HandleRequest(int clientFd, DaemonCommand command, MessageReader &reader);
+    [[nodiscard]] std::shared_ptr<Session> FindSession(std::uint32_t sessionId);
+
+    std::string _socketPath;
+    std::atomic_int _listenFd = -1;
+    std::atomic_bool _isStopping = false;
+
+    std::mutex _mutex;
+    std::map<std::uint32_t, std::shared_ptr<Session>> _sessions;
+    std::uint32_t _nextSessionId = 1;
+    std::vector<int> _clientFds; // each served by a detached thread
+    std::condition_variable _clientCond;
+};
+
+/**
+ * @brief Client of Daemon. Each call is one round trip; std::nullopt means an error, which is logged.
+ */
+class DaemonClient {
+public:
+    DaemonClient() = default;
+
+    DaemonClient(const DaemonClient &) = delete;
+    DaemonClient &operator=(const DaemonClient &) = delete;
+
+    ~DaemonClient();
+
+    bool Connect(std::string_view socketPath);
+
+    [[nodiscard]] bool IsConnected() const noexcept {
+        return _fd != -1;
+    }
+
+    /**
+     * @brief Start a session for a process and its sub-processes.
+     * @return The session ID.
+     */
+    [[nodiscard]] std::optional<std::uint32_t> Attach(std::string_view processName);
+
+    [[nodiscard]] std::optional<std::uint32_t> Attach(const PidList &pids);
+
+    bool Detach(std::uint32_t session);
+
+    /**
+     * @brief Replace the result set of the session by a new scan.
+     * @return Count of results.
+     */
+    template <Arithmetic T>
+    [[nodiscard]] std::optional<std::uint64_t> Scan(std::uint32_t session, MemPart memPart, MatchMode mode, T value, T maxValue = T{}) {
+        MessageWriter writer;
+        writer.Put(session).Put(ValueTypeOf<T>()).Put(std::uint8_t(memPart)).Put(mode).Put(EncodeValue(value)).Put(EncodeValue(maxValue));
+        return CallForCount(DaemonCommand::SCAN, writer);
+    }
+
+    /**
+     * @brief Refine the result set of the session, by the values at address + offset.
+     * @return Count of results.
+     */
+    template <Arithmetic T>
+    [[nodiscard]] std::optional<std::uint64_t> Filter(std::uint32_t session, MatchMode mode, T value, T maxValue = T{}, std::int64_t offset = 0) {
+        MessageWriter writer;
+        writer.Put(session).Put(ValueTypeOf<T>()).Put(mode).Put(offset).Put(EncodeValue(value)).Put(EncodeValue(maxValue));
+        return CallForCount(DaemonCommand::FILTER, writer);
+    }
+
+    /**
+     * @brief Fetch up to maxCount results, streamed by the daemon.
+     */
+    [[nodiscard]] std::optional<PidAddrMap> Results(std::uint32_t session, std::uint64_t maxCount = UINT64_MAX);
+
+    /**
+     * @return Count of successful writes.
+     */
+    template <Arithmetic T>
+    std::optional<std::uint64_t> Write(std::uint32_t session, T value) {
+        MessageWriter writer;
+        writer.Put(session).Put(ValueTypeOf<T>()).Put(EncodeValue(value));
+        return CallForCount(DaemonCommand::WRITE, writer);
+    }
+
+    /**
+     * @brief Keep writing the value to the current results every intervalMs, until Unlock.
+     * @return Count of locked addresses.
+     */
+    template <Arithmetic T>
+    std::optional<std::uint64_t> Lock(std::uint32_t session, T value, std::uint32_t intervalMs = 100) {
+        MessageWriter writer;
+        writer.Put(session).Put(ValueTypeOf<T>()).Put(EncodeValue(value)).Put(intervalMs);
+        return CallForCount(DaemonCommand::LOCK, writer);
+    }
+
+    bool Unlock(std::uint32_t session);
+
+    /**
+     * @return Count of processes frozen.
+     */
+    std::optional<std::uint64_t> Freeze(std::uint32_t session);
+
+    /**
+     * @return Count of processes resumed.
+     */
+    std::optional<std::uint64_t> Resume(std::uint32_t session);
+
+    /**
+     * @return Count of results saved.
+     */
+    std::optional<std::uint64_t> SaveSnapshot(std::uint32_t session, std::uint8_t slot);
+
+    /**
+     * @brief Replace the result set by a saved one.
+     * @return Count of results.
+     */
+    std::optional<std::uint64_t> LoadSnapshot(std::uint32_t session, std::uint8_t slot);
+
+protected:
+    template <Arithmetic T>
+    static constexpr ValueType ValueTypeOf() {
+        static_assert(sizeof(T) <= sizeof(std::uint64_t), "no ValueType for T, e.g. long double");
+        if constexpr (std::is_floating_point_v<T>) {
+            return (sizeof(T) == sizeof(float)) ? ValueType::FLOAT : ValueType::DOUBLE;
+        } else if constexpr (std::is_signed_v<T>) {
+            constexpr ValueType types[] = {ValueType::INT8, ValueType::INT16, ValueType::INT32, ValueType::INT64};
+            return types[std::bit_width(sizeof(T)) - 1];
+        } else {
+            constexpr ValueType types[] = {ValueType::UINT8, ValueType::UINT16, ValueType::UINT32, ValueType::UINT64};
+            return types[std::bit_width(sizeof(T)) - 1];
+        }
+    }
+
+    /**
+     * @brief Send a request and receive the first response frame.
+     * @return The payload of an OK or MORE frame.
+     */
+    std::optional<std::string> Call(DaemonCommand command, const MessageWriter &writer, DaemonStatus *status = nullptr);
+    std::optional<std::uint64_t> CallForCount(DaemonCommand command, const MessageWriter &writer);
+
+    int _fd = -1;
+};
+
+} // namespace ame
+
+#endif // AME_DAEMON_H
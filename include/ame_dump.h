@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_DUMP_H
+#define AME_DUMP_H
+
+#include "ame_memory.h"
+
+#include <sys/types.h>
+
+#include <cstdint>
+
+#include <string_view>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief A region in a dump file, see DumpMemory.
+ */
+struct DumpRegion {
+    MemRegion region;
+    std::uint64_t dataOffset; // in the dump file, page aligned
+};
+
+/**
+ * @brief Dump the regions of a process in the partition to a file.
+ *
+ * The file starts with an index of the regions (address, size, permissions, path), followed by the content of each
+ * region at a page aligned offset, so it can be mapped for offline analysis. Pages that could not be read are left
+ * as holes of zeros.
+ *
+ * @return Count of bytes dumped, or -1 for errors.
+ */
+std::int64_t DumpMemory(pid_t pid, MemPart memPart, std::string_view filePath);
+
+/**
+ * @brief Read the index of a dump file.
+ * @return The regions, or an empty list for errors.
+ */
+[[nodiscard]] std::vector<DumpRegion> ReadDumpIndex(std::string_view filePath);
+
+/**
+ * @brief Write every region of a dump file back to the same addresses of a process.
+ * @return Count of bytes written, or -1 for errors.
+ */
+std::int64_t RestoreMemory(pid_t pid, std::string_view filePath);
+
+} // namespace ame
+
+#endif // AME_DUMP_H
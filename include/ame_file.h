@@ -32,12 +32,21 @@ namespace ame {
 
 class FileWrapper {
 public:
-    FileWrapper(std::string_view file, int oflag)
-        : _fd{open64(file.data(), oflag)} {}
+    /**
+     * @param [in] mode  Permissions of a file created with O_CREAT.
+     */
+    FileWrapper(std::string_view file, int oflag, mode_t mode = 0)
+        : _fd{open64(file.data(), oflag, mode)} {}
 
     explicit FileWrapper(std::string_view file)
         : FileWrapper{file, O_RDWR} {}
 
+    /**
+     * @brief Open FILE relative to the directory DIRFD, see openat(2).
+     */
+    FileWrapper(int dirFd, std::string_view file, int oflag)
+        : _fd{openat(dirFd, file.data(), oflag)} {}
+
     FileWrapper(const FileWrapper &) = delete;
 
     FileWrapper(FileWrapper &&other) noexcept
@@ -62,6 +71,20 @@ public:
         return _fd != -1;
     }
 
+    [[nodiscard]] int GetFd() const noexcept {
+        return _fd;
+    }
+
+    /**
+     * @brief Read NBYTES into BUF from FD at the current file pointer.
+     * @return The number read.
+     * @retval -1  for errors.
+     * @retval 0  for EOF.
+     */
+    ssize_t Read(void *buf, std::size_t nbytes) {
+        return read(_fd, buf, nbytes);
+    }
+
     /**
      * @brief Read NBYTES into BUF from FD at the given position OFFSET without changing the file pointer.
      * @return The number read.
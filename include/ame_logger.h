@@ -17,14 +17,38 @@
  * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+
 #ifndef AME_LOGGER_H
 #define AME_LOGGER_H
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <source_location>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+// Values of AME_MIN_LOG_LEVEL, the lowest level compiled in. LOG_* macros below it expand to nothing.
+#define AME_LOG_LEVEL_DEBUG 0
+#define AME_LOG_LEVEL_INFO 1
+#define AME_LOG_LEVEL_WARN 2
+#define AME_LOG_LEVEL_ERROR 3
+#define AME_LOG_LEVEL_OFF 4
+
+#ifndef AME_MIN_LOG_LEVEL
+#define AME_MIN_LOG_LEVEL AME_LOG_LEVEL_DEBUG
+#endif
 
 namespace ame {
 
@@ -56,6 +80,55 @@ public:
         _level = level;
     }
 
+    [[nodiscard]] bool IsAsync() const noexcept {
+        return _isAsync.load(std::memory_order_acquire); // pairs with the release store that publishes _records
+    }
+
+    /**
+     * @brief Switch between synchronous output and asynchronous output.
+     *
+     * In asynchronous mode, a message is copied into a lock-free ring buffer with its arguments, and formatted and
+     * written by a background thread. A message is dropped rather than waited for if the buffer is full.
+     * Switching back to synchronous mode writes out all pending messages.
+     */
+    void SetAsync(bool isAsync) {
+        const std::lock_guard lock{_asyncMutex};
+        if (isAsync == IsAsync()) {
+            return;
+        }
+        if (isAsync) {
+            if (!_records) {
+                _records = std::make_unique<Record[]>(recordCount);
+                for (std::size_t i = 0; i < recordCount; ++i) {
+                    _records[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+            _writer = std::jthread{[this](std::stop_token stopToken) { WriterLoop(stopToken); }};
+            _isAsync.store(true, std::memory_order_release);
+        } else {
+            _isAsync.store(false, std::memory_order_seq_cst);
+            _writer = {}; // stop and join, the writer drains the buffer before exiting
+        }
+    }
+
+    /**
+     * @brief Wait until the background thread has written all messages logged before this call.
+     */
+    void Flush() const {
+        using namespace std::chrono_literals;
+        const std::size_t tail = _tail.load(std::memory_order_acquire);
+        while (IsAsync() && (_head.load(std::memory_order_acquire) < tail)) {
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    /**
+     * @return Count of messages dropped because the ring buffer was full.
+     */
+    [[nodiscard]] std::uint64_t DroppedCount() const noexcept {
+        return _droppedCount.load(std::memory_order_relaxed);
+    }
+
     template <typename... Args>
     void Debug(std::source_location location, std::format_string<Args...> format, Args &&...args) {
         Output(location, LogLevel::DEBUG, format.get(), std::forward<Args>(args)...);
@@ -77,20 +150,211 @@ public:
     }
 
 protected:
+    using Clock = std::chrono::system_clock;
+    using FormatFunc = std::string (*)(std::string_view format, const std::byte *argData);
+
+    static constexpr std::size_t recordCount = 4096; // power of 2
+    static constexpr std::size_t argCapacity = 192;
+
+    /**
+     * @brief A message waiting in the ring buffer, with its arguments copied into argData.
+     */
+    struct Record {
+        std::atomic_size_t sequence;
+        Clock::time_point time;
+        std::source_location location;
+        LogLevel level;
+        std::string_view format; // always a string literal
+        FormatFunc formatFunc;
+        std::array<std::byte, argCapacity> argData;
+    };
+
+    // Strings are copied by content, other arguments must be trivially copyable to be copied as bytes.
+    template <typename T>
+    static constexpr bool isStringArg = std::is_convertible_v<const T &, std::string_view>;
+
+    template <typename T>
+    static constexpr bool isCopyableArg = isStringArg<T> || std::is_trivially_copyable_v<T>;
+
+    template <typename T>
+    using StoredArg = std::conditional_t<isStringArg<T>, std::string_view, T>;
+
     Logger() = default;
-    ~Logger() = default;
 
-    void Output(std::source_location location, LogLevel level, std::string_view format, auto &&...args) {
+    ~Logger() {
+        SetAsync(false);
+    }
+
+    template <typename... Args>
+    void Output(std::source_location location, LogLevel level, std::string_view format, Args &&...args) {
         if (level < _level) {
             return;
         }
+        if (IsAsync()) {
+            Enqueue(location, level, format, args...);
+            return;
+        }
+        Write(location, level, Clock::now(), std::vformat(format, std::make_format_args(args...)));
+    }
 
+    void Write(std::source_location location, LogLevel level, Clock::time_point time, std::string_view message) {
         std::ostream &stream = (level < LogLevel::ERROR) ? std::clog : std::cerr;
-        const auto now = std::chrono::system_clock::now();
+        // "\033[39m" -> default color
+        std::println(stream, "{}[{:%T}][{}] [{}] {}\033[39m", _colorStrs[int(level)], time, _levelChars[int(level)], location.function_name(), message);
+    }
+
+    template <typename T>
+    static std::size_t ArgSize(const T &arg) {
+        if constexpr (isStringArg<T>) {
+            return sizeof(std::size_t) + std::string_view{arg}.size();
+        } else {
+            return sizeof(T);
+        }
+    }
+
+    template <typename T>
+    static std::byte *StoreArg(std::byte *data, const T &arg) {
+        if constexpr (isStringArg<T>) {
+            const std::string_view str{arg};
+            const std::size_t size = str.size();
+            std::memcpy(data, &size, sizeof(size));
+            std::memcpy(data + sizeof(size), str.data(), size);
+            return data + sizeof(size) + size;
+        } else {
+            std::memcpy(data, &arg, sizeof(T));
+            return data + sizeof(T);
+        }
+    }
+
+    template <typename T>
+    static StoredArg<T> LoadArg(const std::byte *&data) {
+        if constexpr (isStringArg<T>) {
+            std::size_t size;
+            std::memcpy(&size, data, sizeof(size));
+            const std::string_view str{reinterpret_cast<const char *>(data + sizeof(size)), size};
+            data += sizeof(size) + size;
+            return str;
+        } else {
+            T arg;
+            std::memcpy(&arg, data, sizeof(T));
+            data += sizeof(T);
+            return arg;
+        }
+    }
+
+    template <typename... Args>
+    static std::string FormatStored(std::string_view format, [[maybe_unused]] const std::byte *argData) {
+        // Braced initialization evaluates left to right.
+        std::tuple<StoredArg<Args>...> args{LoadArg<Args>(argData)...};
+        return std::apply([format](auto &...storedArgs) { return std::vformat(format, std::make_format_args(storedArgs...)); }, args);
+    }
+
+    template <typename... Args>
+    void Enqueue(std::source_location location, LogLevel level, std::string_view format, const Args &...args) {
+        const auto time = Clock::now();
+        std::size_t pos = _tail.load(std::memory_order_relaxed);
+        Record *record;
+        while (true) {
+            record = &_records[pos & (recordCount - 1)];
+            const std::size_t sequence = record->sequence.load(std::memory_order_acquire);
+            const auto diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos);
+            if (diff == 0) {
+                if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                _droppedCount.fetch_add(1, std::memory_order_relaxed);
+                return; // full
+            } else {
+                pos = _tail.load(std::memory_order_relaxed);
+            }
+        }
+
+        record->time = time;
+        record->location = location;
+        record->level = level;
+        if constexpr ((isCopyableArg<std::decay_t<const Args &>> && ...)) {
+            if ((ArgSize<std::decay_t<const Args &>>(args) + ... + 0) <= argCapacity) {
+                std::byte *data = record->argData.data();
+                ((data = StoreArg<std::decay_t<const Args &>>(data, args)), ...);
+                record->format = format;
+                record->formatFunc = &FormatStored<std::decay_t<const Args &>...>;
+                Commit(*record, pos);
+                return;
+            }
+        }
+        // Too large or not copyable: format now, and keep as much of the message as fits.
         const std::string message = std::vformat(format, std::make_format_args(args...));
+        const std::string_view truncated = std::string_view{message}.substr(0, argCapacity - sizeof(std::size_t));
+        StoreArg<std::string_view>(record->argData.data(), truncated);
+        record->format = "{}";
+        record->formatFunc = &FormatStored<std::string_view>;
+        Commit(*record, pos);
+    }
 
-        // "\033[39m" -> default color
-        std::println(stream, "{}[{:%T}][{}] [{}] {}\033[39m", _colorStrs[int(level)], now, _levelChars[int(level)], location.function_name(), message);
+    /**
+     * @brief Publish a filled record, and wake the writer thread if it waits.
+     */
+    void Commit(Record &record, std::size_t pos) {
+        record.sequence.store(pos + 1, std::memory_order_release);
+        // Pairs with the seq_cst accesses of SetAsync(false) and WriterLoop: either they see the record, or this
+        // thread sees that they are waiting or gone.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_isWriterIdle.load(std::memory_order_relaxed)) {
+            _wakeCount.fetch_add(1, std::memory_order_relaxed);
+            _wakeCount.notify_one();
+        }
+        if (!_isAsync.load(std::memory_order_relaxed)) {
+            // Switched to synchronous mode after this thread took the slot: the writer may be gone already.
+            const std::lock_guard lock{_asyncMutex};
+            if (!IsAsync()) {
+                Drain();
+            }
+        }
+    }
+
+    /**
+     * @return Whether any message was written.
+     */
+    bool Drain() {
+        bool isWritten = false;
+        for (std::size_t head = _head.load(std::memory_order_relaxed);; ++head) {
+            Record &record = _records[head & (recordCount - 1)];
+            if (record.sequence.load(std::memory_order_acquire) != head + 1) {
+                break; // empty, or not yet filled
+            }
+            Write(record.location, record.level, record.time, record.formatFunc(record.format, record.argData.data()));
+            record.sequence.store(head + recordCount, std::memory_order_release);
+            _head.store(head + 1, std::memory_order_release);
+            isWritten = true;
+        }
+        return isWritten;
+    }
+
+    [[nodiscard]] bool IsHeadReady() const noexcept {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        return _records[head & (recordCount - 1)].sequence.load(std::memory_order_acquire) == head + 1;
+    }
+
+    void WriterLoop(std::stop_token stopToken) {
+        const std::stop_callback wakeOnStop{stopToken, [this] {
+            _wakeCount.fetch_add(1, std::memory_order_seq_cst);
+            _wakeCount.notify_one();
+        }};
+        while (!stopToken.stop_requested()) {
+            if (Drain()) {
+                continue;
+            }
+            // Sleep until a producer commits a record, see Commit.
+            const std::uint32_t wakeCount = _wakeCount.load(std::memory_order_seq_cst);
+            _isWriterIdle.store(true, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (!IsHeadReady() && !stopToken.stop_requested()) {
+                _wakeCount.wait(wakeCount, std::memory_order_seq_cst);
+            }
+            _isWriterIdle.store(false, std::memory_order_relaxed);
+        }
+        Drain();
     }
 
     static constexpr std::array<std::string_view, 4> _colorStrs = {
@@ -103,13 +367,42 @@ protected:
     static constexpr std::array<char, 4> _levelChars = {'D', 'I', 'W', 'E'};
 
     LogLevel _level = LogLevel::DEBUG;
+
+    std::atomic_bool _isAsync = false;
+    std::mutex _asyncMutex;
+    std::unique_ptr<Record[]> _records;
+    alignas(64) std::atomic_size_t _tail = 0; // next position to write, shared by producers
+    alignas(64) std::atomic_size_t _head = 0; // next position to read, owned by the writer thread
+    std::atomic_uint64_t _droppedCount = 0;
+    std::atomic_bool _isWriterIdle = false;
+    std::atomic_uint32_t _wakeCount = 0;
+    std::jthread _writer;
 };
 
 } // namespace ame
 
+#if AME_MIN_LOG_LEVEL <= AME_LOG_LEVEL_DEBUG
 #define LOG_DEBUG(...) ame::Logger::Instance().Debug(std::source_location::current(), __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+#if AME_MIN_LOG_LEVEL <= AME_LOG_LEVEL_INFO
 #define LOG_INFO(...) ame::Logger::Instance().Info(std::source_location::current(), __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if AME_MIN_LOG_LEVEL <= AME_LOG_LEVEL_WARN
 #define LOG_WARN(...) ame::Logger::Instance().Warn(std::source_location::current(), __VA_ARGS__)
+#else
+#define LOG_WARN(...) ((void)0)
+#endif
+
+#if AME_MIN_LOG_LEVEL <= AME_LOG_LEVEL_ERROR
 #define LOG_ERROR(...) ame::Logger::Instance().Error(std::source_location::current(), __VA_ARGS__)
+#else
+#define LOG_ERROR(...) ((void)0)
+#endif
 
 #endif // AME_LOGGER_H
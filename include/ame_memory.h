@@ -20,14 +20,29 @@
 #ifndef AME_MEMORY_H
 #define AME_MEMORY_H
 
+#include "ame_buffer_pool.h"
+#include "ame_control.h"
 #include "ame_file.h"
 #include "ame_logger.h"
+#include "ame_process.h"
+#include "ame_stats.h"
+#include "ame_thread_pool.h"
 
 #include <fcntl.h>
+#include <unistd.h>
 
+#include <cassert>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 
+#include <algorithm>
+#include <array>
 #include <format>
+#include <map>
+#include <numeric>
+#include <span>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -36,6 +51,7 @@ namespace ame {
 // Use uint64_t rather than uintptr_t/unsigned long.
 using AddrRangeList = std::vector<std::pair<std::uint64_t, std::uint64_t>>;
 using AddrList = std::vector<std::uint64_t>;
+using PidAddrMap = std::map<pid_t, AddrList>;
 
 template <typename T>
 concept Arithmetic = std::is_arithmetic_v<T>;
@@ -58,160 +74,500 @@ enum class MemPart {
     V,            // v内存
 };
 
+/**
+ * @brief A line of /proc/<pid>/maps.
+ */
+struct MemRegion {
+    std::uint64_t beginAddr;
+    std::uint64_t endAddr;
+    std::string perms; // e.g. "rw-p"
+    std::string path;  // e.g. "[anon:libc_malloc]", empty for anonymous memory
+};
+
 [[nodiscard]] bool IsAreaBelongToPart(MemPart memPart, const std::string &vmAreaStr);
 
+[[nodiscard]] std::vector<MemRegion> GetMemRegions(pid_t pid, MemPart memPart);
+
 [[nodiscard]] AddrRangeList GetAddrRange(pid_t pid, MemPart memPart);
 
 
+// A task reads width - 1 bytes past its end; up to scanOverlapSize of them, it still fits in a BufferPool buffer.
+inline constexpr std::size_t scanOverlapSize = 4096;
+inline constexpr std::size_t scanChunkSize = BufferPool::bufferSize - scanOverlapSize; // bytes of a region per scan task
+inline constexpr std::size_t filterChunkSize = 4096;                                   // addresses of a list per filter task
+
 /**
- * @brief Find addresses that *address == value.
- * @tparam T  base data type, e.g. short, int, float, long.
+ * @brief Part of a memory region, scanned by one worker.
  */
-template <Arithmetic T>
-[[nodiscard]] AddrList FindAddress(pid_t pid, MemPart memPart, T valueToFind) {
-    AddrList result;
+struct ScanTask {
+    std::size_t procIndex; // index in ScanPlan::pids
+    std::uint64_t beginAddr;
+    std::uint64_t endAddr;
+    std::uint64_t regionEndAddr;
+};
 
-    const AddrRangeList addrRangeList = GetAddrRange(pid, memPart);
-    if (addrRangeList.empty()) {
-        LOG_ERROR("Failed to get address range.");
-        return result;
+/**
+ * @brief The regions of several processes, split into tasks for the thread pool.
+ */
+struct ScanPlan {
+    PidList pids;
+    std::vector<FileWrapper *> memFiles;  // of pids, given to PlanScan or in openedFiles
+    std::vector<FileWrapper> openedFiles; // moving the plan keeps the addresses of these
+    std::vector<ScanTask> tasks;    // by process, then address
+    std::vector<std::size_t> order; // indices of tasks in the order to scan
+    std::uint64_t totalBytes = 0;
+};
+
+/**
+ * @brief Read the regions of pids in memPart, and split them into tasks.
+ *
+ * @param [in] memFiles  Open mem files of pids, in the same order, to save reopening them; empty, or a null entry, to
+ *                       open the file of that PID here.
+ */
+[[nodiscard]] ScanPlan PlanScan(const PidList &pids, MemPart memPart, RegionOrder regionOrder = RegionOrder::ADDRESS,
+                                std::span<const MemPart> partPriority = {}, std::span<FileWrapper *const> memFiles = {});
+
+ssize_t ReadMem(FileWrapper &memFile, void *buf, std::size_t nbytes, std::uint64_t address);
+
+ssize_t WriteMem(FileWrapper &memFile, const void *buf, std::size_t n, std::uint64_t address);
+
+/**
+ * @brief Read [beginAddr, endAddr) of a process in bulk, and pass each readable piece to callback.
+ *
+ * A page that could not be read (e.g. a guard page) is skipped, so a piece never crosses it.
+ *
+ * @param [in] buffer  At least endAddr - beginAddr bytes, e.g. a BufferPool::Block.
+ * @param [in] callback  void(std::uint64_t pieceAddr, std::span<const std::byte> piece)
+ */
+template <typename Callback>
+void ReadMemRange(FileWrapper &memFile, std::uint64_t beginAddr, std::uint64_t endAddr, std::span<std::byte> buffer, Callback &&callback) {
+    if (beginAddr >= endAddr) {
+        return;
+    }
+    static const std::uint64_t pageSize = sysconf(_SC_PAGESIZE);
+
+    assert(buffer.size() >= endAddr - beginAddr);
+    std::uint64_t pieceAddr = beginAddr;
+    std::uint64_t address = beginAddr;
+    while (address < endAddr) {
+        const ssize_t nbytes = ReadMem(memFile, buffer.data() + (address - beginAddr), endAddr - address, address);
+        if (nbytes > 0) {
+            address += nbytes;
+            continue;
+        }
+        // Unreadable page: hand over what was read before it, then resume at the next page.
+        if (address > pieceAddr) {
+            callback(pieceAddr, std::span<const std::byte>{buffer.data() + (pieceAddr - beginAddr), address - pieceAddr});
+        }
+        address = std::min((address / pageSize + 1) * pageSize, endAddr);
+        pieceAddr = address;
+    }
+    if (address > pieceAddr) {
+        callback(pieceAddr, std::span<const std::byte>{buffer.data() + (pieceAddr - beginAddr), address - pieceAddr});
     }
+}
 
-    const std::string memPath = std::format("/proc/{}/mem", pid);
-    FileWrapper memFile{memPath, O_RDONLY};
-    if (!memFile.IsOpen()) {
-        LOG_ERROR("Failed to open [{}].", memPath);
-        return result;
+/**
+ * @brief Keep at most maxResults addresses, those of the first tasks in order; 0 for no limit.
+ * @return Whether any address was dropped.
+ */
+bool TrimTaskResults(std::vector<AddrChunkList> &taskResults, std::span<const std::size_t> order, std::size_t maxResults);
+
+
+/**
+ * @brief A matcher that takes a whole readable piece of memory at once, e.g. to scan it in blocks or with memchr.
+ *
+ * MatchPiece(firstAddr, data, count, step, result) appends to result (an AddrChunkList) the matching addresses among
+ * firstAddr + i * step for i in [0, count). data starts at firstAddr and holds all bytes of the last address.
+ */
+template <typename M>
+concept PieceMatcher = requires(const M &matcher, std::uint64_t firstAddr, std::span<const std::byte> data, std::size_t count, std::size_t step, AddrChunkList &result) {
+    matcher.MatchPiece(firstAddr, data, count, step, result);
+};
+
+/**
+ * @brief Find addresses in the regions of plan that matcher(address) is true.
+ *
+ * plan is left as is, so it can be scanned again, with the regions of when it was made.
+ * @param [in] width  Bytes that matcher reads from each address.
+ * @param [in] step  Alignment of the addresses.
+ * @param [in] matcher  bool(const std::byte *), or a PieceMatcher; called from the worker threads.
+ */
+template <typename Matcher>
+[[nodiscard]] PidAddrMap ScanProcesses(ScanPlan &plan, std::size_t width, std::size_t step, const Matcher &matcher) {
+    PidAddrMap result;
+    ScanStats *const stats = ScanStats::Current();
+    ScanLimiter limiter{ScanControl::Current()};
+    PhaseTimer timer;
+
+    limiter.SetTotalBytes(plan.totalBytes);
+    std::vector<AddrChunkList> taskResults(plan.tasks.size());
+    std::vector<RegionStats> taskStats(stats ? plan.tasks.size() : 0);
+    if (stats) {
+        stats->planNs += timer.Lap();
     }
 
-    LOG_INFO("Find address by value of ({}) start.", valueToFind);
-    for (const auto &[beginAddr, endAddr] : addrRangeList) {
-        for (std::uint64_t address = beginAddr; address <= endAddr; address += sizeof(std::int32_t)) {
-            T value;
-            if ((memFile.PRead64(&value, sizeof(value), address) > 0) && (value == valueToFind)) {
-                result.push_back(address);
-            }
+    ThreadPool::Instance().ParallelFor(plan.order.size(), [&](std::size_t orderIndex) {
+        const std::size_t taskIndex = plan.order[orderIndex];
+        const ScanTask &task = plan.tasks[taskIndex];
+        AddrChunkList &taskResult = taskResults[taskIndex];
+        TaskMeter meter{stats != nullptr};
+        if (limiter.BeginTask(task.endAddr - task.beginAddr)) {
+            const std::uint64_t readEndAddr = std::min(task.endAddr + width - 1, task.regionEndAddr);
+            const BufferPool::Block buffer = BufferPool::Instance().Acquire(readEndAddr - task.beginAddr);
+            ReadMemRange(*plan.memFiles[task.procIndex], task.beginAddr, readEndAddr, {buffer.Data(), buffer.Size()}, [&](std::uint64_t pieceAddr, std::span<const std::byte> piece) {
+                const std::uint64_t pieceEndAddr = pieceAddr + piece.size();
+                const std::uint64_t firstAddr = (pieceAddr + step - 1) / step * step;
+                if ((firstAddr >= task.endAddr) || (firstAddr + width > pieceEndAddr)) {
+                    return;
+                }
+                // Count of addresses in [firstAddr, task.endAddr) with all width bytes in the piece.
+                const std::size_t count = std::min((task.endAddr - 1 - firstAddr) / step, (pieceEndAddr - width - firstAddr) / step) + 1;
+                if constexpr (PieceMatcher<Matcher>) {
+                    matcher.MatchPiece(firstAddr, piece.subspan(firstAddr - pieceAddr), count, step, taskResult);
+                } else {
+                    const std::byte *data = piece.data() + (firstAddr - pieceAddr);
+                    for (std::size_t i = 0; i < count; ++i, data += step) {
+                        if (matcher(data)) {
+                            taskResult.PushBack(firstAddr + i * step);
+                        }
+                    }
+                }
+            });
+            limiter.EndTask(task.endAddr - task.beginAddr, taskResult.Size());
+        }
+        if (stats) {
+            taskStats[taskIndex] = meter.Finish(plan.pids[task.procIndex], task.beginAddr, task.endAddr, taskResult.Size());
+        }
+    });
+    if (TrimTaskResults(taskResults, plan.order, limiter.MaxResults())) {
+        limiter.Stop(ScanStopReason::MAX_RESULTS);
+    }
+    limiter.Finish();
+
+    if (stats) {
+        stats->scanNs += timer.Lap();
+        for (std::size_t i = 0; i < plan.tasks.size(); ++i) {
+            const bool isSameRegion = (i > 0) && (plan.tasks[i].procIndex == plan.tasks[i - 1].procIndex) && (plan.tasks[i].regionEndAddr == plan.tasks[i - 1].regionEndAddr);
+            taskStats[i].matchCount = taskResults[i].Size(); // as returned, after TrimTaskResults
+            stats->AddTask(taskStats[i], isSameRegion);
         }
     }
-    LOG_INFO("Find address end.");
 
+    // Tasks are ordered by process then address, so each list stays sorted.
+    std::vector<std::size_t> procResultSizes(plan.pids.size());
+    for (std::size_t i = 0; i < plan.tasks.size(); ++i) {
+        procResultSizes[plan.tasks[i].procIndex] += taskResults[i].Size();
+    }
+    for (std::size_t procIndex = 0; procIndex < plan.pids.size(); ++procIndex) {
+        result[plan.pids[procIndex]].reserve(procResultSizes[procIndex]);
+    }
+    for (std::size_t i = 0; i < plan.tasks.size(); ++i) {
+        taskResults[i].AppendTo(result[plan.pids[plan.tasks[i].procIndex]]);
+    }
+    if (stats) {
+        stats->mergeNs += timer.Lap();
+    }
     return result;
 }
 
 
 /**
- * @brief Find addresses that minValue <= *address <= maxValue.
- * @tparam T  base data type, e.g. short, int, float, long.
+ * @brief Plan the scan of pids and run ScanProcesses on it.
+ *
+ * The regions are taken in ScanControl::Current()->regionOrder, if any.
  */
-template <Arithmetic T>
-[[nodiscard]] AddrList FindAddressByRange(pid_t pid, MemPart memPart, T minValue, T maxValue) {
-    AddrList result;
-
-    if (minValue > maxValue) {
-        LOG_ERROR("minValue ({}) > maxValue ({})", minValue, maxValue);
-        return result;
+template <typename Matcher>
+[[nodiscard]] PidAddrMap ScanProcesses(const PidList &pids, MemPart memPart, std::size_t width, std::size_t step, const Matcher &matcher) {
+    ScanStats *const stats = ScanStats::Current();
+    ScanControl *const control = ScanControl::Current();
+    PhaseTimer timer;
+
+    ScanPlan plan = control ? PlanScan(pids, memPart, control->regionOrder, control->partPriority) : PlanScan(pids, memPart);
+    if (stats) {
+        stats->planNs += timer.Lap();
     }
+    return ScanProcesses(plan, width, step, matcher);
+}
+
 
-    const AddrRangeList addrRangeList = GetAddrRange(pid, memPart);
-    if (addrRangeList.empty()) {
-        LOG_ERROR("Failed to get address range.");
-        return result;
+/**
+ * @brief Keep addresses in lists that matcher(address + offset) is true.
+ *
+ * @param [in] lists  Pairs of PID and addresses in that process.
+ * @param [in] memFiles  Open mem files of the lists, in the same order, to save reopening them; empty, or a null
+ *                       entry, to open the file of that PID here.
+ * @param [in] width  Bytes that matcher reads from each address.
+ * @param [in] matcher  bool(const std::byte *), called from the worker threads.
+ * @return The filtered lists, in the same order as lists.
+ */
+template <typename Matcher>
+[[nodiscard]] std::vector<AddrList> FilterProcesses(std::span<const std::pair<pid_t, std::span<const std::uint64_t>>> lists, std::span<FileWrapper *const> memFiles,
+                                                    std::size_t width, std::int64_t offset, const Matcher &matcher) {
+    std::vector<AddrList> result(lists.size());
+    ScanStats *const stats = ScanStats::Current();
+    ScanLimiter limiter{ScanControl::Current()};
+    PhaseTimer timer;
+
+    struct FilterTask {
+        std::size_t listIndex;
+        std::size_t beginIndex;
+        std::size_t endIndex;
+    };
+    std::vector<FileWrapper> openedFiles;
+    openedFiles.reserve(lists.size()); // listFiles point into it
+    std::vector<FileWrapper *> listFiles(lists.size());
+    std::vector<FilterTask> tasks;
+    for (std::size_t i = 0; i < lists.size(); ++i) {
+        const auto &[pid, addrList] = lists[i];
+        listFiles[i] = (i < memFiles.size()) ? memFiles[i] : nullptr;
+        if (!listFiles[i]) {
+            const std::string memPath = std::format("/proc/{}/mem", pid);
+            listFiles[i] = &openedFiles.emplace_back(memPath, O_RDONLY);
+            if (!listFiles[i]->IsOpen()) {
+                LOG_ERROR("Failed to open [{}].", memPath);
+                continue;
+            }
+        }
+        for (std::size_t begin = 0; begin < addrList.size(); begin += filterChunkSize) {
+            tasks.push_back({i, begin, std::min(begin + filterChunkSize, addrList.size())});
+        }
     }
 
-    const std::string memPath = std::format("/proc/{}/mem", pid);
-    FileWrapper memFile{memPath, O_RDONLY};
-    if (!memFile.IsOpen()) {
-        LOG_ERROR("Failed to open [{}].", memPath);
-        return result;
+    std::uint64_t totalBytes = 0;
+    for (const FilterTask &task : tasks) {
+        totalBytes += (task.endIndex - task.beginIndex) * width;
+    }
+    limiter.SetTotalBytes(totalBytes);
+    std::vector<AddrChunkList> taskResults(tasks.size());
+    std::vector<ScanCounters> taskCounters(stats ? tasks.size() : 0);
+    if (stats) {
+        stats->planNs += timer.Lap();
     }
 
-    LOG_INFO("Find address by value in ({}, {}) start.", minValue, maxValue);
-    for (const auto &[beginAddr, endAddr] : addrRangeList) {
-        for (std::uint64_t address = beginAddr; address <= endAddr; address += sizeof(std::int32_t)) {
-            T value;
-            if ((memFile.PRead64(&value, sizeof(value), address) > 0) //
-                && (minValue <= value) && (value <= maxValue)) {
-                result.push_back(address);
+    ThreadPool::Instance().ParallelFor(tasks.size(), [&](std::size_t taskIndex) {
+        const FilterTask &task = tasks[taskIndex];
+        FileWrapper &memFile = *listFiles[task.listIndex];
+        const std::span<const std::uint64_t> addrList = lists[task.listIndex].second;
+        const std::uint64_t taskBytes = (task.endIndex - task.beginIndex) * width;
+        if (!limiter.BeginTask(taskBytes)) {
+            return;
+        }
+        const ScanCounters startCounters = ThreadScanCounters();
+        // A value fits on the stack; only long arrays and strings need the heap.
+        std::array<std::byte, 256> stackBuffer;
+        std::vector<std::byte> heapBuffer(width > stackBuffer.size() ? width : 0);
+        std::byte *const buffer = heapBuffer.empty() ? stackBuffer.data() : heapBuffer.data();
+        for (std::size_t i = task.beginIndex; i < task.endIndex; ++i) {
+            const std::uint64_t address = addrList[i];
+            if ((ReadMem(memFile, buffer, width, address + offset) == std::int64_t(width)) && matcher(buffer)) {
+                taskResults[taskIndex].PushBack(address);
             }
         }
+        limiter.EndTask(taskBytes, taskResults[taskIndex].Size());
+        if (stats) {
+            taskCounters[taskIndex] = ThreadScanCounters() - startCounters;
+        }
+    });
+    if (const std::size_t maxResults = limiter.MaxResults(); maxResults != 0) {
+        std::vector<std::size_t> order(tasks.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        if (TrimTaskResults(taskResults, order, maxResults)) {
+            limiter.Stop(ScanStopReason::MAX_RESULTS);
+        }
     }
-    LOG_INFO("Find address end.");
+    limiter.Finish();
 
+    if (stats) {
+        stats->scanNs += timer.Lap();
+        for (std::size_t i = 0; i < tasks.size(); ++i) {
+            stats->counters += taskCounters[i];
+            stats->matchCount += taskResults[i].Size();
+        }
+    }
+
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+        result[tasks[i].listIndex].reserve(result[tasks[i].listIndex].size() + taskResults[i].Size());
+        taskResults[i].AppendTo(result[tasks[i].listIndex]);
+    }
+    if (stats) {
+        stats->mergeNs += timer.Lap();
+    }
     return result;
 }
 
 
 /**
- * @brief Find addresses that *((T *)address) == items[0], *((T *)address + 1) == values[1], ...
+ * @brief Apply FilterProcesses to every list of a PidAddrMap.
+ */
+template <typename Matcher>
+[[nodiscard]] PidAddrMap FilterPidAddrMap(const PidAddrMap &mapToFilter, std::size_t width, std::int64_t offset, const Matcher &matcher) {
+    std::vector<std::pair<pid_t, std::span<const std::uint64_t>>> lists;
+    for (const auto &[pid, addrList] : mapToFilter) {
+        lists.emplace_back(pid, addrList);
+    }
+    std::vector<AddrList> filtered = FilterProcesses(lists, {}, width, offset, matcher);
+
+    PidAddrMap result;
+    for (std::size_t i = 0; i < lists.size(); ++i) {
+        result.emplace(lists[i].first, std::move(filtered[i]));
+    }
+    return result;
+}
+
+
+/**
+ * @brief Apply FilterProcesses to the list of a single process.
+ */
+template <typename Matcher>
+[[nodiscard]] AddrList FilterProcess(pid_t pid, const AddrList &listToFilter, std::size_t width, std::int64_t offset, const Matcher &matcher) {
+    const std::pair<pid_t, std::span<const std::uint64_t>> list{pid, listToFilter};
+    return std::move(FilterProcesses({&list, 1}, {}, width, offset, matcher).front());
+}
+
+
+/**
+ * @brief Read a T from a scan buffer, which is not aligned for T.
+ */
+template <Arithmetic T>
+[[nodiscard]] T LoadValue(const std::byte *data) noexcept {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+
+/**
+ * @brief Find addresses in all processes that *address == value.
  * @tparam T  base data type, e.g. short, int, float, long.
  */
 template <Arithmetic T>
-[[nodiscard]] AddrList FindArrayAddress(pid_t pid, MemPart memPart, const std::vector<T> &values) {
-    AddrList result;
+[[nodiscard]] PidAddrMap FindAddress(const PidList &pids, MemPart memPart, T valueToFind) {
+    LOG_INFO("Find address by value of ({}) start.", valueToFind);
+    PidAddrMap result = ScanProcesses(pids, memPart, sizeof(T), sizeof(std::int32_t), [valueToFind](const std::byte *data) {
+        return LoadValue<T>(data) == valueToFind;
+    });
+    LOG_INFO("Find address end.");
+    return result;
+}
 
-    if (values.empty()) {
-        LOG_ERROR("values is empty.");
-        return result;
-    }
 
-    const AddrRangeList addrRangeList = GetAddrRange(pid, memPart);
-    if (addrRangeList.empty()) {
-        LOG_ERROR("Failed to get address range.");
-        return result;
+/**
+ * @brief Find addresses that *address == value.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] AddrList FindAddress(pid_t pid, MemPart memPart, T valueToFind) {
+    return std::move(FindAddress(PidList{pid}, memPart, valueToFind)[pid]);
+}
+
+
+/**
+ * @brief Find addresses in all processes that minValue <= *address <= maxValue.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] PidAddrMap FindAddressByRange(const PidList &pids, MemPart memPart, T minValue, T maxValue) {
+    if (minValue > maxValue) {
+        LOG_ERROR("minValue ({}) > maxValue ({})", minValue, maxValue);
+        return {};
     }
 
-    const std::string memPath = std::format("/proc/{}/mem", pid);
-    FileWrapper memFile{memPath, O_RDONLY};
-    if (!memFile.IsOpen()) {
-        LOG_ERROR("Failed to open [{}].", memPath);
-        return result;
+    LOG_INFO("Find address by value in ({}, {}) start.", minValue, maxValue);
+    PidAddrMap result = ScanProcesses(pids, memPart, sizeof(T), sizeof(std::int32_t), [minValue, maxValue](const std::byte *data) {
+        const T value = LoadValue<T>(data);
+        return (minValue <= value) && (value <= maxValue);
+    });
+    LOG_INFO("Find address end.");
+    return result;
+}
+
+
+/**
+ * @brief Find addresses that minValue <= *address <= maxValue.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] AddrList FindAddressByRange(pid_t pid, MemPart memPart, T minValue, T maxValue) {
+    return std::move(FindAddressByRange(PidList{pid}, memPart, minValue, maxValue)[pid]);
+}
+
+
+/**
+ * @brief Find addresses in all processes that *((T *)address) == items[0], *((T *)address + 1) == values[1], ...
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] PidAddrMap FindArrayAddress(const PidList &pids, MemPart memPart, const std::vector<T> &values) {
+    if (values.empty()) {
+        LOG_ERROR("values is empty.");
+        return {};
     }
 
     LOG_INFO("Find address with group of values start.");
-    std::vector<T> buffer(values.size());
-    for (const auto &[beginAddr, endAddr] : addrRangeList) {
-        for (std::uint64_t address = beginAddr; address <= endAddr; address += sizeof(std::int32_t)) {
-            if ((memFile.PRead64(buffer.data(), buffer.size() * sizeof(T), address) > 0) && (buffer == values)) {
-                LOG_DEBUG("Find Address: 0x{:X}", address);
-                result.push_back(address);
+    PidAddrMap result = ScanProcesses(pids, memPart, values.size() * sizeof(T), sizeof(std::int32_t), [&values](const std::byte *data) {
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (LoadValue<T>(data + i * sizeof(T)) != values[i]) {
+                return false;
             }
         }
-    }
+        return true;
+    });
     LOG_INFO("Find address end.");
-
     return result;
 }
 
 
 /**
- * @brief Find addresses in list that *(address + offset) == value.
+ * @brief Find addresses that *((T *)address) == items[0], *((T *)address + 1) == values[1], ...
  * @tparam T  base data type, e.g. short, int, float, long.
  */
 template <Arithmetic T>
-[[nodiscard]] AddrList FilterAddrListByOffset(pid_t pid, const AddrList &listToFilter, T valueToFind, std::int64_t offset) {
-    AddrList result;
+[[nodiscard]] AddrList FindArrayAddress(pid_t pid, MemPart memPart, const std::vector<T> &values) {
+    return std::move(FindArrayAddress(PidList{pid}, memPart, values)[pid]);
+}
 
-    const std::string memPath = std::format("/proc/{}/mem", pid);
-    FileWrapper memFile{memPath, O_RDONLY};
-    if (!memFile.IsOpen()) {
-        LOG_ERROR("Failed to open [{}].", memPath);
-        return result;
-    }
 
+/**
+ * @brief Find addresses in all lists that *(address + offset) == value.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] PidAddrMap FilterAddrListByOffset(const PidAddrMap &mapToFilter, T valueToFind, std::int64_t offset) {
     LOG_INFO("Filter address by value of ({}) and offset of ({}) start.", valueToFind, offset);
-    for (const auto &address : listToFilter) {
-        T value;
-        if ((memFile.PRead64(&value, sizeof(value), address + offset) > 0) && (value == valueToFind)) {
-            LOG_DEBUG("Find Address: 0x{:X}", address);
-            result.push_back(address);
-        }
-    }
+    PidAddrMap result = FilterPidAddrMap(mapToFilter, sizeof(T), offset, [valueToFind](const std::byte *data) {
+        return LoadValue<T>(data) == valueToFind;
+    });
     LOG_INFO("Filter address end.");
+    return result;
+}
 
+
+/**
+ * @brief Find addresses in list that *(address + offset) == value.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] AddrList FilterAddrListByOffset(pid_t pid, const AddrList &listToFilter, T valueToFind, std::int64_t offset) {
+    LOG_INFO("Filter address by value of ({}) and offset of ({}) start.", valueToFind, offset);
+    AddrList result = FilterProcess(pid, listToFilter, sizeof(T), offset, [valueToFind](const std::byte *data) {
+        return LoadValue<T>(data) == valueToFind;
+    });
+    LOG_INFO("Filter address end.");
     return result;
 }
 
 
+/**
+ * @brief Find addresses in all lists that *address == value.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] PidAddrMap FilterAddrList(const PidAddrMap &mapToFilter, T value) {
+    return FilterAddrListByOffset(mapToFilter, value, 0);
+}
+
+
 /**
  * @brief Find addresses in list that *address == value.
  * @tparam T  base data type, e.g. short, int, float, long.
@@ -223,40 +579,46 @@ template <Arithmetic T>
 
 
 /**
- * @brief Find addresses in list that minValue <= *address <= maxValue.
+ * @brief Find addresses in all lists that minValue <= *address <= maxValue.
  * @tparam T  base data type, e.g. short, int, float, long.
  */
 template <Arithmetic T>
-[[nodiscard]] AddrList FilterAddrListByRange(pid_t pid, const AddrList &listToFilter, T minValue, T maxValue) {
-    AddrList result;
-
+[[nodiscard]] PidAddrMap FilterAddrListByRange(const PidAddrMap &mapToFilter, T minValue, T maxValue) {
     if (minValue > maxValue) {
         LOG_ERROR("minValue ({}) > maxValue ({})", minValue, maxValue);
-        return result;
+        return {};
     }
 
-    const std::string memPath = std::format("/proc/{}/mem", pid);
-    FileWrapper memFile{memPath, O_RDONLY};
-    if (!memFile.IsOpen()) {
-        LOG_ERROR("Failed to open [{}].", memPath);
-        return result;
+    LOG_INFO("Filter address by value in ({}, {}) start.", minValue, maxValue);
+    PidAddrMap result = FilterPidAddrMap(mapToFilter, sizeof(T), 0, [minValue, maxValue](const std::byte *data) {
+        const T value = LoadValue<T>(data);
+        return (minValue <= value) && (value <= maxValue);
+    });
+    LOG_INFO("Filter address end.");
+    return result;
+}
+
+
+/**
+ * @brief Find addresses in list that minValue <= *address <= maxValue.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T>
+[[nodiscard]] AddrList FilterAddrListByRange(pid_t pid, const AddrList &listToFilter, T minValue, T maxValue) {
+    if (minValue > maxValue) {
+        LOG_ERROR("minValue ({}) > maxValue ({})", minValue, maxValue);
+        return {};
     }
 
     LOG_INFO("Filter address by value in ({}, {}) start.", minValue, maxValue);
-    for (const auto &address : listToFilter) {
-        T value;
-        if ((memFile.PRead64(&value, sizeof(value), address) > 0) //
-            && (minValue <= value) && (value <= maxValue)) {
-            LOG_DEBUG("Find Address: 0x{:X}", address);
-            result.push_back(address);
-        }
-    }
+    AddrList result = FilterProcess(pid, listToFilter, sizeof(T), 0, [minValue, maxValue](const std::byte *data) {
+        const T value = LoadValue<T>(data);
+        return (minValue <= value) && (value <= maxValue);
+    });
     LOG_INFO("Filter address end.");
-
     return result;
 }
 
-
 /**
  * @brief Write the value to the addresses in addrList.
  *
@@ -278,13 +640,20 @@ int WriteAddressGroup(pid_t pid, const AddrList &addrList, T value, std::size_t
         return -1;
     }
 
+    PhaseTimer timer;
+    const ScanCounters startCounters = ThreadScanCounters();
     int successCount = 0;
     auto it = addrList.cbegin();
     for (std::size_t i = 0; (i < groupSize) && (it != addrList.cend()); ++i, ++it) {
-        if (memFile.PWrite64(&value, sizeof(value), *it) != -1) {
+        if (WriteMem(memFile, &value, sizeof(value), *it) != -1) {
             ++successCount;
         }
     }
+    if (ScanStats *const stats = ScanStats::Current()) {
+        stats->counters += ThreadScanCounters() - startCounters;
+        stats->matchCount += successCount;
+        stats->writeNs += timer.Lap();
+    }
     return successCount;
 }
 
@@ -308,12 +677,19 @@ int WriteArrayAddress(pid_t pid, const AddrList &addrList, const std::vector<T>
         return -1;
     }
 
+    PhaseTimer timer;
+    const ScanCounters startCounters = ThreadScanCounters();
     int successCount = 0;
     for (const auto &address : addrList) {
-        if (memFile.PWrite64(values.data(), values.size() * sizeof(T), address) != -1) {
+        if (WriteMem(memFile, values.data(), values.size() * sizeof(T), address) != -1) {
             ++successCount;
         }
     }
+    if (ScanStats *const stats = ScanStats::Current()) {
+        stats->counters += ThreadScanCounters() - startCounters;
+        stats->matchCount += successCount;
+        stats->writeNs += timer.Lap();
+    }
     return successCount;
 }
 
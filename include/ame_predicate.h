@@ -0,0 +1,646 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_PREDICATE_H
+#define AME_PREDICATE_H
+
+#include "ame_logger.h"
+#include "ame_memory.h"
+
+#include <sys/types.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief Arithmetic of predicates in T, the same for predicate expressions and PredicateKernel.
+ *
+ * Integer arithmetic wraps around instead of overflowing, and integer division or modulo by 0 gives 0.
+ */
+template <Arithmetic T>
+struct PredicateMath {
+    // Done in 64-bit unsigned, since unsigned types narrower than int are promoted to (signed) int, where e.g.
+    // 0xFFFF * 0xFFFF overflows.
+    using Wide = std::conditional_t<std::is_integral_v<T>, std::uint64_t, T>;
+
+    static constexpr Wide Widen(T x) noexcept {
+        return Wide(x);
+    }
+
+    static constexpr T Wrap(Wide x) noexcept {
+        return T(x);
+    }
+
+    static constexpr T Negate(T x) noexcept {
+        return Wrap(-Widen(x));
+    }
+
+    static constexpr T Add(T x, T y) noexcept {
+        return Wrap(Widen(x) + Widen(y));
+    }
+
+    static constexpr T Subtract(T x, T y) noexcept {
+        return Wrap(Widen(x) - Widen(y));
+    }
+
+    static constexpr T Multiply(T x, T y) noexcept {
+        return Wrap(Widen(x) * Widen(y));
+    }
+
+    static constexpr T Divide(T x, T y) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            if (y == T{}) {
+                return T{};
+            }
+            if constexpr (std::is_signed_v<T>) {
+                if (y == T(-1)) {
+                    return Negate(x); // avoid overflow of MIN / -1
+                }
+            }
+        }
+        return x / y;
+    }
+
+    static constexpr T Modulo(T x, T y) noexcept {
+        if constexpr (std::is_integral_v<T>) {
+            if ((y == T{}) || (std::is_signed_v<T> && (y == T(-1)))) {
+                return T{};
+            }
+            return x % y;
+        } else {
+            return std::fmod(x, y);
+        }
+    }
+
+    // The shift count is taken modulo the bits of T.
+    static constexpr T ShiftLeft(T x, T y) noexcept {
+        return Wrap(Widen(x) << (Widen(y) & (sizeof(T) * 8 - 1)));
+    }
+
+    static constexpr T ShiftRight(T x, T y) noexcept {
+        return T(x >> (Widen(y) & (sizeof(T) * 8 - 1)));
+    }
+};
+
+/**
+ * @brief Predicates built at compile time, e.g. (value != 0) && (value % 10 == 0), or (value & 0x0F) == 0x0F.
+ *
+ * Each expression is a callable bool(T) for every T it is valid for, so FindAddressIf inlines it into one kernel.
+ * Values are computed in T by the rules of PredicateMath, as PredicateKernel does, and && and || short-circuit.
+ */
+namespace predicate {
+
+template <typename E>
+concept Expr = requires { typename E::IsExpr; };
+
+struct ValueExpr {
+    using IsExpr = void;
+
+    template <Arithmetic T>
+    constexpr T Eval(T value) const noexcept {
+        return value;
+    }
+};
+
+template <Arithmetic C>
+struct ConstExpr {
+    using IsExpr = void;
+
+    C constant;
+
+    template <Arithmetic T>
+    constexpr T Eval(T) const noexcept {
+        return T(constant); // compare and compute in the scanned type
+    }
+};
+
+// Operations on values in T; conditions give T(0) or T(1), which is what the registers of PredicateKernel hold.
+#define AME_PREDICATE_BINARY_OPERATION(Name, expression) \
+    struct Name {                                        \
+        template <Arithmetic T>                          \
+        constexpr T operator()(T x, T y) const {         \
+            return expression;                           \
+        }                                                \
+    };
+
+#define AME_PREDICATE_UNARY_OPERATION(Name, expression) \
+    struct Name {                                       \
+        template <Arithmetic T>                         \
+        constexpr T operator()(T x) const {             \
+            return expression;                          \
+        }                                               \
+    };
+
+AME_PREDICATE_BINARY_OPERATION(Equal, T(x == y))
+AME_PREDICATE_BINARY_OPERATION(NotEqual, T(x != y))
+AME_PREDICATE_BINARY_OPERATION(Less, T(x < y))
+AME_PREDICATE_BINARY_OPERATION(LessEqual, T(x <= y))
+AME_PREDICATE_BINARY_OPERATION(Greater, T(x > y))
+AME_PREDICATE_BINARY_OPERATION(GreaterEqual, T(x >= y))
+AME_PREDICATE_BINARY_OPERATION(Add, PredicateMath<T>::Add(x, y))
+AME_PREDICATE_BINARY_OPERATION(Subtract, PredicateMath<T>::Subtract(x, y))
+AME_PREDICATE_BINARY_OPERATION(Multiply, PredicateMath<T>::Multiply(x, y))
+AME_PREDICATE_BINARY_OPERATION(Divide, PredicateMath<T>::Divide(x, y))
+AME_PREDICATE_BINARY_OPERATION(Modulo, PredicateMath<T>::Modulo(x, y))
+AME_PREDICATE_BINARY_OPERATION(BitAnd, T(x & y))
+AME_PREDICATE_BINARY_OPERATION(BitOr, T(x | y))
+AME_PREDICATE_BINARY_OPERATION(BitXor, T(x ^ y))
+AME_PREDICATE_BINARY_OPERATION(ShiftLeft, PredicateMath<T>::ShiftLeft(x, y))
+AME_PREDICATE_BINARY_OPERATION(ShiftRight, PredicateMath<T>::ShiftRight(x, y))
+AME_PREDICATE_UNARY_OPERATION(LogicalNot, T(x == T{}))
+AME_PREDICATE_UNARY_OPERATION(Negate, PredicateMath<T>::Negate(x))
+AME_PREDICATE_UNARY_OPERATION(BitNot, T(~x))
+
+#undef AME_PREDICATE_BINARY_OPERATION
+#undef AME_PREDICATE_UNARY_OPERATION
+
+// && and ||, evaluated by BinaryExpr so the right operand is skipped when the left one decides.
+struct LogicalAnd {};
+struct LogicalOr {};
+
+template <typename Op, Expr E>
+struct UnaryExpr {
+    using IsExpr = void;
+
+    E operand;
+
+    template <Arithmetic T>
+    constexpr T Eval(T value) const {
+        return Op{}(operand.Eval(value));
+    }
+
+    template <Arithmetic T>
+    constexpr bool operator()(T value) const {
+        return bool(Eval(value));
+    }
+};
+
+template <typename Op, Expr L, Expr R>
+struct BinaryExpr {
+    using IsExpr = void;
+
+    L left;
+    R right;
+
+    template <Arithmetic T>
+    constexpr T Eval(T value) const {
+        if constexpr (std::is_same_v<Op, LogicalAnd>) {
+            return T((left.Eval(value) != T{}) && (right.Eval(value) != T{}));
+        } else if constexpr (std::is_same_v<Op, LogicalOr>) {
+            return T((left.Eval(value) != T{}) || (right.Eval(value) != T{}));
+        } else {
+            return Op{}(left.Eval(value), right.Eval(value));
+        }
+    }
+
+    template <Arithmetic T>
+    constexpr bool operator()(T value) const {
+        return bool(Eval(value));
+    }
+};
+
+template <typename T>
+constexpr auto AsExpr(T operand) {
+    if constexpr (Expr<T>) {
+        return operand;
+    } else {
+        return ConstExpr<T>{operand};
+    }
+}
+
+template <typename L, typename R>
+concept ExprOperands = (Expr<L> || Expr<R>) && (Expr<L> || Arithmetic<L>) && (Expr<R> || Arithmetic<R>);
+
+#define AME_PREDICATE_BINARY_OPERATOR(op, Op)                                                                            \
+    template <typename L, typename R>                                                                                    \
+        requires ExprOperands<L, R>                                                                                      \
+    constexpr auto operator op(L left, R right) {                                                                        \
+        return BinaryExpr<Op, decltype(AsExpr(left)), decltype(AsExpr(right))>{AsExpr(left), AsExpr(right)}; \
+    }
+
+AME_PREDICATE_BINARY_OPERATOR(==, Equal)
+AME_PREDICATE_BINARY_OPERATOR(!=, NotEqual)
+AME_PREDICATE_BINARY_OPERATOR(<, Less)
+AME_PREDICATE_BINARY_OPERATOR(<=, LessEqual)
+AME_PREDICATE_BINARY_OPERATOR(>, Greater)
+AME_PREDICATE_BINARY_OPERATOR(>=, GreaterEqual)
+AME_PREDICATE_BINARY_OPERATOR(&&, LogicalAnd)
+AME_PREDICATE_BINARY_OPERATOR(||, LogicalOr)
+AME_PREDICATE_BINARY_OPERATOR(+, Add)
+AME_PREDICATE_BINARY_OPERATOR(-, Subtract)
+AME_PREDICATE_BINARY_OPERATOR(*, Multiply)
+AME_PREDICATE_BINARY_OPERATOR(/, Divide)
+AME_PREDICATE_BINARY_OPERATOR(%, Modulo)
+AME_PREDICATE_BINARY_OPERATOR(&, BitAnd)
+AME_PREDICATE_BINARY_OPERATOR(|, BitOr)
+AME_PREDICATE_BINARY_OPERATOR(^, BitXor)
+AME_PREDICATE_BINARY_OPERATOR(<<, ShiftLeft)
+AME_PREDICATE_BINARY_OPERATOR(>>, ShiftRight)
+
+#undef AME_PREDICATE_BINARY_OPERATOR
+
+template <Expr E>
+constexpr auto operator!(E operand) {
+    return UnaryExpr<LogicalNot, E>{operand};
+}
+
+template <Expr E>
+constexpr auto operator-(E operand) {
+    return UnaryExpr<Negate, E>{operand};
+}
+
+template <Expr E>
+constexpr auto operator~(E operand) {
+    return UnaryExpr<BitNot, E>{operand};
+}
+
+/**
+ * @brief The value at the address.
+ */
+inline constexpr ValueExpr value{};
+
+} // namespace predicate
+
+
+/**
+ * @brief A predicate parsed at runtime, before it is compiled for a type, see CompilePredicate.
+ *
+ * Grammar, with the precedence of Go (bitwise operators bind tighter than comparisons):
+ *     or      := and ("||" and)*
+ *     and     := not ("&&" not)*
+ *     not     := "!" not | compare
+ *     compare := sum (("==" | "!=" | "<" | "<=" | ">" | ">=") sum)?
+ *     sum     := product (("+" | "-" | "|" | "^") product)*
+ *     product := unary (("*" | "/" | "%" | "&" | "<<" | ">>") unary)*
+ *     unary   := ("-" | "~") unary | "value" | number | "(" or ")"
+ * A number is decimal, 0x hexadecimal or floating point. A number used as a condition means != 0.
+ */
+struct PredicateAst {
+    enum class Op : std::uint8_t {
+        VALUE,
+        CONST,
+        NEG,
+        BIT_NOT,
+        ADD,
+        SUB,
+        MUL,
+        DIV,
+        MOD,
+        BIT_AND,
+        BIT_OR,
+        BIT_XOR,
+        SHL,
+        SHR,
+        // conditions
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        AND,
+        OR,
+        NOT,
+        TO_BOOL, // != 0
+    };
+
+    struct Node {
+        Op op;
+        std::uint32_t left = 0;  // index of an operand node
+        std::uint32_t right = 0; // index of an operand node
+        std::int64_t intConstant = 0;
+        double floatConstant = 0.0;
+        bool isFloatConstant = false;
+    };
+
+    std::vector<Node> nodes; // operands before operators, the last one is the root condition
+
+    [[nodiscard]] static bool IsCondition(Op op) noexcept {
+        return op >= Op::EQ;
+    }
+};
+
+[[nodiscard]] std::optional<PredicateAst> ParsePredicate(std::string_view expression);
+
+
+/**
+ * @brief A runtime predicate compiled for T, run over blocks of values.
+ *
+ * Each node of the expression is one pass over a block of values (a register), so the loops are tight and free of
+ * per-value dispatch. Used as a PieceMatcher by FindAddressIf, and as bool(T) for filters.
+ */
+template <Arithmetic T>
+class PredicateKernel {
+public:
+    static constexpr std::size_t blockSize = 256;
+
+    /**
+     * @return The kernel, or std::nullopt if the expression uses an operator that T does not have (e.g. & on float).
+     */
+    [[nodiscard]] static std::optional<PredicateKernel> Compile(const PredicateAst &ast) {
+        PredicateKernel kernel;
+        for (const PredicateAst::Node &node : ast.nodes) {
+            if constexpr (std::is_floating_point_v<T>) {
+                switch (node.op) {
+                    case PredicateAst::Op::BIT_NOT:
+                    case PredicateAst::Op::BIT_AND:
+                    case PredicateAst::Op::BIT_OR:
+                    case PredicateAst::Op::BIT_XOR:
+                    case PredicateAst::Op::SHL:
+                    case PredicateAst::Op::SHR:
+                        LOG_ERROR("Bitwise operators are not valid for floating point values.");
+                        return std::nullopt;
+                    default:
+                        break;
+                }
+            }
+            Instr instr{node.op, node.left, node.right, T{}};
+            if (node.op == PredicateAst::Op::CONST) {
+                instr.constant = node.isFloatConstant ? T(node.floatConstant) : T(node.intConstant);
+            }
+            kernel._program.push_back(instr);
+        }
+        if (kernel._program.empty() || !PredicateAst::IsCondition(kernel._program.back().op)) {
+            LOG_ERROR("Predicate is not a condition.");
+            return std::nullopt;
+        }
+        return kernel;
+    }
+
+    /**
+     * @brief Evaluate for count values, loaded from data every step bytes; out[i] is 0 or 1.
+     * @param [in] regs  Registers of stride values each, from PrepareRegisters.
+     */
+    void EvalBlock(const std::byte *data, std::size_t count, std::size_t step, std::uint8_t *out, T *regs, std::size_t stride) const {
+        for (std::size_t reg = 0; reg < _program.size(); ++reg) {
+            T *dst = &regs[reg * stride];
+            const Instr &instr = _program[reg];
+            const T *a = &regs[instr.left * stride];
+            const T *b = &regs[instr.right * stride];
+            switch (instr.op) {
+                case PredicateAst::Op::VALUE:
+                    for (std::size_t i = 0; i < count; ++i) {
+                        std::memcpy(&dst[i], data + i * step, sizeof(T));
+                    }
+                    break;
+                case PredicateAst::Op::CONST:
+                    break; // filled by PrepareRegisters
+                case PredicateAst::Op::NEG:
+                    Apply(dst, count, a, a, [](T x, T) { return Math::Negate(x); });
+                    break;
+                case PredicateAst::Op::BIT_NOT:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, a, [](T x, T) { return T(~x); });
+                    }
+                    break;
+                case PredicateAst::Op::ADD:
+                    Apply(dst, count, a, b, [](T x, T y) { return Math::Add(x, y); });
+                    break;
+                case PredicateAst::Op::SUB:
+                    Apply(dst, count, a, b, [](T x, T y) { return Math::Subtract(x, y); });
+                    break;
+                case PredicateAst::Op::MUL:
+                    Apply(dst, count, a, b, [](T x, T y) { return Math::Multiply(x, y); });
+                    break;
+                case PredicateAst::Op::DIV:
+                    Apply(dst, count, a, b, [](T x, T y) { return Math::Divide(x, y); });
+                    break;
+                case PredicateAst::Op::MOD:
+                    Apply(dst, count, a, b, [](T x, T y) { return Math::Modulo(x, y); });
+                    break;
+                case PredicateAst::Op::BIT_AND:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, b, [](T x, T y) { return T(x & y); });
+                    }
+                    break;
+                case PredicateAst::Op::BIT_OR:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, b, [](T x, T y) { return T(x | y); });
+                    }
+                    break;
+                case PredicateAst::Op::BIT_XOR:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, b, [](T x, T y) { return T(x ^ y); });
+                    }
+                    break;
+                case PredicateAst::Op::SHL:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, b, [](T x, T y) { return Math::ShiftLeft(x, y); });
+                    }
+                    break;
+                case PredicateAst::Op::SHR:
+                    if constexpr (std::is_integral_v<T>) {
+                        Apply(dst, count, a, b, [](T x, T y) { return Math::ShiftRight(x, y); });
+                    }
+                    break;
+                case PredicateAst::Op::EQ:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x == y); });
+                    break;
+                case PredicateAst::Op::NE:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x != y); });
+                    break;
+                case PredicateAst::Op::LT:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x < y); });
+                    break;
+                case PredicateAst::Op::LE:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x <= y); });
+                    break;
+                case PredicateAst::Op::GT:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x > y); });
+                    break;
+                case PredicateAst::Op::GE:
+                    Apply(dst, count, a, b, [](T x, T y) { return T(x >= y); });
+                    break;
+                case PredicateAst::Op::AND:
+                    Apply(dst, count, a, b, [](T x, T y) { return T((x != T{}) & (y != T{})); });
+                    break;
+                case PredicateAst::Op::OR:
+                    Apply(dst, count, a, b, [](T x, T y) { return T((x != T{}) | (y != T{})); });
+                    break;
+                case PredicateAst::Op::NOT:
+                    Apply(dst, count, a, a, [](T x, T) { return T(x == T{}); });
+                    break;
+                case PredicateAst::Op::TO_BOOL:
+                    Apply(dst, count, a, a, [](T x, T) { return T(x != T{}); });
+                    break;
+            }
+        }
+        const T *result = &regs[(_program.size() - 1) * stride];
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = (result[i] != T{});
+        }
+    }
+
+    /**
+     * @brief Allocate registers of stride values each, with the constants filled in.
+     */
+    void PrepareRegisters(std::vector<T> &regs, std::size_t stride) const {
+        regs.resize(_program.size() * stride);
+        for (std::size_t reg = 0; reg < _program.size(); ++reg) {
+            if (_program[reg].op == PredicateAst::Op::CONST) {
+                std::fill_n(&regs[reg * stride], stride, _program[reg].constant);
+            }
+        }
+    }
+
+    void MatchPiece(std::uint64_t firstAddr, std::span<const std::byte> data, std::size_t count, std::size_t step, AddrChunkList &result) const {
+        thread_local std::vector<T> regs; // reused by every piece on the thread
+        PrepareRegisters(regs, blockSize);
+        std::uint8_t matches[blockSize];
+        for (std::size_t begin = 0; begin < count; begin += blockSize) {
+            const std::size_t blockCount = std::min(blockSize, count - begin);
+            EvalBlock(data.data() + begin * step, blockCount, step, matches, regs.data(), blockSize);
+            for (std::size_t i = 0; i < blockCount; ++i) {
+                if (matches[i]) {
+                    result.PushBack(firstAddr + (begin + i) * step);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Evaluate for a single value, for filters.
+     */
+    bool operator()(T value) const {
+        static constexpr std::size_t localRegCount = 32;
+        std::uint8_t match;
+        if (_program.size() <= localRegCount) {
+            T regs[localRegCount];
+            for (std::size_t reg = 0; reg < _program.size(); ++reg) {
+                regs[reg] = _program[reg].constant;
+            }
+            EvalBlock(reinterpret_cast<const std::byte *>(&value), 1, sizeof(T), &match, regs, 1);
+        } else {
+            std::vector<T> regs;
+            PrepareRegisters(regs, 1);
+            EvalBlock(reinterpret_cast<const std::byte *>(&value), 1, sizeof(T), &match, regs.data(), 1);
+        }
+        return match;
+    }
+
+protected:
+    struct Instr {
+        PredicateAst::Op op;
+        std::uint32_t left;
+        std::uint32_t right;
+        T constant;
+    };
+
+    using Math = PredicateMath<T>;
+
+    template <typename Func>
+    static void Apply(T *dst, std::size_t count, const T *a, const T *b, Func func) {
+        for (std::size_t i = 0; i < count; ++i) {
+            dst[i] = func(a[i], b[i]);
+        }
+    }
+
+    std::vector<Instr> _program; // register i holds the result of _program[i]
+};
+
+/**
+ * @brief Parse and compile a predicate for T.
+ */
+template <Arithmetic T>
+[[nodiscard]] std::optional<PredicateKernel<T>> CompilePredicate(std::string_view expression) {
+    const auto ast = ParsePredicate(expression);
+    if (!ast.has_value()) {
+        return std::nullopt;
+    }
+    return PredicateKernel<T>::Compile(*ast);
+}
+
+
+/**
+ * @brief Find addresses in all processes that predicate(*address) is true, in a single pass.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ * @param [in] predicate  A predicate::Expr, a PredicateKernel<T>, or any bool(T).
+ */
+template <Arithmetic T, typename Predicate>
+[[nodiscard]] PidAddrMap FindAddressIf(const PidList &pids, MemPart memPart, const Predicate &predicate) {
+    LOG_INFO("Find address by predicate start.");
+    PidAddrMap result;
+    if constexpr (PieceMatcher<Predicate>) {
+        result = ScanProcesses(pids, memPart, sizeof(T), sizeof(std::int32_t), predicate);
+    } else {
+        result = ScanProcesses(pids, memPart, sizeof(T), sizeof(std::int32_t), [&predicate](const std::byte *data) {
+            return bool(predicate(LoadValue<T>(data)));
+        });
+    }
+    LOG_INFO("Find address end.");
+    return result;
+}
+
+
+/**
+ * @brief Find addresses that predicate(*address) is true, in a single pass.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T, typename Predicate>
+[[nodiscard]] AddrList FindAddressIf(pid_t pid, MemPart memPart, const Predicate &predicate) {
+    return std::move(FindAddressIf<T>(PidList{pid}, memPart, predicate)[pid]);
+}
+
+
+/**
+ * @brief Find addresses in all lists that predicate(*(address + offset)) is true.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T, typename Predicate>
+[[nodiscard]] PidAddrMap FilterAddrListIf(const PidAddrMap &mapToFilter, const Predicate &predicate, std::int64_t offset = 0) {
+    LOG_INFO("Filter address by predicate and offset of ({}) start.", offset);
+    PidAddrMap result = FilterPidAddrMap(mapToFilter, sizeof(T), offset, [&predicate](const std::byte *data) {
+        return bool(predicate(LoadValue<T>(data)));
+    });
+    LOG_INFO("Filter address end.");
+    return result;
+}
+
+
+/**
+ * @brief Find addresses in list that predicate(*(address + offset)) is true.
+ * @tparam T  base data type, e.g. short, int, float, long.
+ */
+template <Arithmetic T, typename Predicate>
+[[nodiscard]] AddrList FilterAddrListIf(pid_t pid, const AddrList &listToFilter, const Predicate &predicate, std::int64_t offset = 0) {
+    LOG_INFO("Filter address by predicate and offset of ({}) start.", offset);
+    AddrList result = FilterProcess(pid, listToFilter, sizeof(T), offset, [&predicate](const std::byte *data) {
+        return bool(predicate(LoadValue<T>(data)));
+    });
+    LOG_INFO("Filter address end.");
+    return result;
+}
+
+} // namespace ame
+
+#endif // AME_PREDICATE_H
@@ -23,13 +23,62 @@
 #include <sys/types.h>
 
 #include <functional>
+#include <map>
 #include <optional>
+#include <string>
 #include <string_view>
+#include <unordered_map>
+#include <vector>
 
 namespace ame {
 
+using PidList = std::vector<pid_t>;
+
+/**
+ * @brief Snapshot of /proc, indexed by both PID and process name.
+ *
+ * Built once by a full walk of /proc, then kept up to date by Refresh(), which only reads the cmdline of PIDs
+ * that were not seen before and drops the ones that have exited.
+ */
+class ProcessTable {
+public:
+    /**
+     * @brief Update the table from /proc.
+     * @param [in] full  Re-read the cmdline of every process instead of only new ones and those not yet renamed
+     *                   from zygote.
+     * @return Whether /proc could be read.
+     */
+    bool Refresh(bool full = false);
+
+    bool Validate(pid_t pid);
+
+    void Clear() noexcept;
+
+    /**
+     * @brief Find all PIDs of a process name.
+     * @param [in] withSubProcess  Also match sub-processes, e.g. "com.example:remote" for "com.example".
+     * @return PIDs in ascending order of name, then PID.
+     */
+    [[nodiscard]] PidList FindPids(std::string_view processName, bool withSubProcess = true) const;
+
+    [[nodiscard]] std::optional<std::string> GetName(pid_t pid) const;
+
+    [[nodiscard]] std::size_t Size() const noexcept {
+        return _nameByPid.size();
+    }
+
+protected:
+    void Insert(pid_t pid, std::string name);
+    void Erase(pid_t pid);
+
+    std::unordered_map<pid_t, std::string> _nameByPid;
+    std::map<std::string, PidList, std::less<>> _pidsByName;
+};
+
 [[nodiscard]] std::optional<pid_t> FindPidByProcessName(std::string_view processName);
 
+[[nodiscard]] PidList FindPidsByProcessName(std::string_view processName, bool withSubProcess = true);
+
 [[nodiscard]] std::optional<bool> IsProcessStopped(pid_t pid);
 
 bool FreezeProcessByPid(pid_t pid);
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_STATS_H
+#define AME_STATS_H
+
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief I/O counters, kept per thread.
+ */
+struct ScanCounters {
+    std::uint64_t syscallCount = 0;
+    std::uint64_t bytesRead = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t shortReadCount = 0;  // read less than requested, e.g. up to a guard page
+    std::uint64_t failedReadCount = 0; // e.g. EIO on a guard page
+    std::uint64_t failedWriteCount = 0;
+
+    ScanCounters &operator+=(const ScanCounters &other) noexcept;
+    [[nodiscard]] ScanCounters operator-(const ScanCounters &other) const noexcept;
+};
+
+/**
+ * @return The counters of the calling thread, updated by every read and write of process memory.
+ */
+[[nodiscard]] ScanCounters &ThreadScanCounters() noexcept;
+
+/**
+ * @brief Statistics of the scan tasks of one memory region.
+ */
+struct RegionStats {
+    pid_t pid = 0;
+    std::uint64_t beginAddr = 0;
+    std::uint64_t endAddr = 0;
+    ScanCounters counters;
+    std::uint64_t matchCount = 0;
+    std::uint64_t nanoseconds = 0; // summed over the workers
+};
+
+/**
+ * @brief Statistics of Find*, Filter* and Write* calls.
+ *
+ * Filled by every such call made on the thread while a ScanStatsScope for it exists. Values are added to, so a
+ * ScanStats may cover several calls.
+ */
+struct ScanStats {
+    ScanCounters counters;
+    std::uint64_t regionCount = 0;
+    std::uint64_t matchCount = 0;
+    std::uint64_t planNs = 0;  // parse maps, open mem files and split tasks
+    std::uint64_t scanNs = 0;  // read and match, by Find* and Filter*
+    std::uint64_t mergeNs = 0; // join the results of tasks
+    std::uint64_t writeNs = 0; // by Write*
+    std::vector<RegionStats> regions;
+
+    /**
+     * @return The ScanStats of the innermost ScanStatsScope on this thread, or nullptr.
+     */
+    [[nodiscard]] static ScanStats *Current() noexcept;
+
+    /**
+     * @param [in] isSameRegion  Whether the task continues the region of the last one.
+     */
+    void AddTask(const RegionStats &task, bool isSameRegion);
+
+    [[nodiscard]] std::string ToJson() const;
+};
+
+/**
+ * @brief Let the Find*, Filter* and Write* calls on this thread fill STATS during the lifetime of the scope.
+ */
+class ScanStatsScope {
+public:
+    explicit ScanStatsScope(ScanStats &stats) noexcept;
+
+    ScanStatsScope(const ScanStatsScope &) = delete;
+    ScanStatsScope &operator=(const ScanStatsScope &) = delete;
+
+    ~ScanStatsScope();
+
+protected:
+    ScanStats *_previous;
+};
+
+/**
+ * @brief Nanoseconds between laps, on the steady clock.
+ */
+class PhaseTimer {
+public:
+    PhaseTimer() noexcept
+        : _last{std::chrono::steady_clock::now()} {}
+
+    std::uint64_t Lap() noexcept {
+        const auto now = std::chrono::steady_clock::now();
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - _last);
+        _last = now;
+        return elapsed.count();
+    }
+
+protected:
+    std::chrono::steady_clock::time_point _last;
+};
+
+/**
+ * @brief Measure a scan task on a worker thread, only if stats are wanted.
+ */
+class TaskMeter {
+public:
+    explicit TaskMeter(bool isEnabled) noexcept
+        : _isEnabled{isEnabled} {
+        if (_isEnabled) {
+            _startCounters = ThreadScanCounters();
+            _timer.Lap();
+        }
+    }
+
+    [[nodiscard]] RegionStats Finish(pid_t pid, std::uint64_t beginAddr, std::uint64_t endAddr, std::uint64_t matchCount) noexcept {
+        if (!_isEnabled) {
+            return {};
+        }
+        return {pid, beginAddr, endAddr, ThreadScanCounters() - _startCounters, matchCount, _timer.Lap()};
+    }
+
+protected:
+    bool _isEnabled;
+    ScanCounters _startCounters;
+    PhaseTimer _timer;
+};
+
+} // namespace ame
+
+#endif // AME_STATS_H
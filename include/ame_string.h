@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_STRING_H
+#define AME_STRING_H
+
+#include "ame_memory.h"
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <string_view>
+#include <vector>
+
+namespace ame {
+
+enum class StringEncoding : std::uint8_t {
+    UTF8,
+    UTF16LE, // e.g. java.lang.String in JAVA_HEAP
+};
+
+/**
+ * @brief Encode UTF-8 text to the bytes it has in memory.
+ * @return The bytes, or an empty list if text is empty or not valid UTF-8.
+ */
+[[nodiscard]] std::vector<std::byte> EncodeString(std::string_view text, StringEncoding encoding);
+
+/**
+ * @brief Find addresses in all processes where the string is stored, at any byte (UTF-8) or any 2 bytes (UTF-16LE).
+ *
+ * Candidates are located with memchr on one byte of the string, so the scan costs about one memory pass.
+ *
+ * @param [in] text  UTF-8 text, without terminating null.
+ * @param [in] ignoreCase  Whether ASCII letters match in either case.
+ */
+[[nodiscard]] PidAddrMap FindStringAddress(const PidList &pids, MemPart memPart, std::string_view text,
+                                           StringEncoding encoding = StringEncoding::UTF8, bool ignoreCase = false);
+
+/**
+ * @brief Find addresses where the string is stored.
+ */
+[[nodiscard]] AddrList FindStringAddress(pid_t pid, MemPart memPart, std::string_view text,
+                                         StringEncoding encoding = StringEncoding::UTF8, bool ignoreCase = false);
+
+/**
+ * @brief Find addresses in all lists where the string is still stored.
+ */
+[[nodiscard]] PidAddrMap FilterStringAddress(const PidAddrMap &mapToFilter, std::string_view text,
+                                             StringEncoding encoding = StringEncoding::UTF8, bool ignoreCase = false);
+
+/**
+ * @brief Find addresses in list where the string is still stored.
+ */
+[[nodiscard]] AddrList FilterStringAddress(pid_t pid, const AddrList &listToFilter, std::string_view text,
+                                           StringEncoding encoding = StringEncoding::UTF8, bool ignoreCase = false);
+
+} // namespace ame
+
+#endif // AME_STRING_H
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef AME_THREAD_POOL_H
+#define AME_THREAD_POOL_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief Fixed set of worker threads shared by all scans.
+ */
+class ThreadPool {
+public:
+    [[nodiscard, gnu::visibility("default")]] static ThreadPool &Instance() {
+        // The calling thread of ParallelFor works too.
+        static ThreadPool pool{std::max(std::thread::hardware_concurrency(), 1U) - 1};
+        return pool;
+    }
+
+    explicit ThreadPool(std::size_t threadCount);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ThreadPool &operator=(ThreadPool &&) = delete;
+
+    ~ThreadPool();
+
+    [[nodiscard]] std::size_t ThreadCount() const noexcept {
+        return _workers.size();
+    }
+
+    /**
+     * @brief Call func(0), func(1), ..., func(count - 1) on the workers and the calling thread, then wait for all.
+     *
+     * The calling thread takes indices too, so this never waits for an idle worker and may be nested.
+     */
+    void ParallelFor(std::size_t count, const std::function<void(std::size_t)> &func);
+
+protected:
+    void Post(std::function<void()> job);
+    void WorkerLoop(std::stop_token stopToken);
+
+    std::mutex _mutex;
+    std::condition_variable_any _jobCond;
+    std::deque<std::function<void()>> _jobs;
+    std::vector<std::jthread> _workers;
+};
+
+} // namespace ame
+
+#endif // AME_THREAD_POOL_H
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_buffer_pool.h"
+
+#include <sys/mman.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ame {
+
+static std::size_t AlignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+
+static std::byte *AllocateBlock(std::size_t size) {
+    void *data = std::aligned_alloc(BufferPool::blockSize, size);
+    if (!data) {
+        throw std::bad_alloc{};
+    }
+#ifdef MADV_HUGEPAGE
+    madvise(data, size, MADV_HUGEPAGE); // only a hint
+#endif
+    return static_cast<std::byte *>(data);
+}
+
+
+BufferPool::~BufferPool() {
+    Trim();
+}
+
+
+void BufferPool::SetBudget(std::size_t budget) {
+    {
+        const std::lock_guard lock{_mutex};
+        _budget = budget;
+    }
+    _releaseCond.notify_all();
+}
+
+
+std::size_t BufferPool::Budget() const {
+    const std::lock_guard lock{_mutex};
+    return _budget;
+}
+
+
+std::size_t BufferPool::UsedBytes() const {
+    const std::lock_guard lock{_mutex};
+    return _usedBytes;
+}
+
+
+std::size_t BufferPool::CachedBytes() const {
+    const std::lock_guard lock{_mutex};
+    return (_freeBlocks.size() + _slabs.size()) * blockSize;
+}
+
+
+BufferPool::Block BufferPool::Acquire(std::size_t size) {
+    const std::size_t blockBytes = (size <= bufferSize) ? bufferSize : AlignUp(size, blockSize);
+    std::unique_lock lock{_mutex};
+    // Another transient block will come back soon; results only come back with the end of their scan.
+    _releaseCond.wait(lock, [this, blockBytes] {
+        return (_budget == 0) || (_usedBytes + blockBytes <= _budget) || (_transientBytes == 0);
+    });
+    std::byte *data = (blockBytes == bufferSize) ? TakePiece(_freeBuffers, bufferSize) : Take(blockBytes); // may throw, so count the block after
+    _usedBytes += blockBytes;
+    _transientBytes += blockBytes;
+    if (blockBytes == bufferSize) {
+        _pieceBytes += bufferSize;
+    }
+    return {this, data, blockBytes, true};
+}
+
+
+BufferPool::Block BufferPool::TryAcquireChunk() {
+    const std::lock_guard lock{_mutex};
+    if ((_budget != 0) && (_usedBytes + chunkSize > _budget)) {
+        return {};
+    }
+    std::byte *data = TakePiece(_freeChunks, chunkSize); // may throw, so count the chunk after
+    _usedBytes += chunkSize;
+    _pieceBytes += chunkSize;
+    return {this, data, chunkSize, false};
+}
+
+
+void BufferPool::Trim() {
+    std::vector<std::byte *> freeBlocks;
+    {
+        const std::lock_guard lock{_mutex};
+        freeBlocks.swap(_freeBlocks);
+        if (_pieceBytes == 0) {
+            FreeSlabs();
+        }
+    }
+    for (std::byte *data : freeBlocks) {
+        std::free(data);
+    }
+}
+
+
+/**
+ * @brief A free block if size is blockSize and one is kept, or new memory; called with _mutex held.
+ */
+std::byte *BufferPool::Take(std::size_t size) {
+    if ((size == blockSize) && !_freeBlocks.empty()) {
+        std::byte *data = _freeBlocks.back();
+        _freeBlocks.pop_back();
+        return data;
+    }
+    return AllocateBlock(size);
+}
+
+
+/**
+ * @brief A free piece of pieceSize bytes, cut from a new slab if none is left; called with _mutex held.
+ */
+std::byte *BufferPool::TakePiece(std::vector<std::byte *> &freePieces, std::size_t pieceSize) {
+    if (freePieces.empty()) {
+        _slabs.reserve(_slabs.size() + 1); // so the slab is not lost if this throws
+        freePieces.reserve(blockSize / pieceSize);
+        std::byte *slab = AllocateBlock(blockSize);
+        _slabs.push_back(slab);
+        for (std::size_t offset = blockSize; offset != 0; offset -= pieceSize) {
+            freePieces.push_back(slab + offset - pieceSize); // so the lowest piece is taken first
+        }
+    }
+    std::byte *data = freePieces.back();
+    freePieces.pop_back();
+    return data;
+}
+
+
+/**
+ * @brief Free all slabs, when no buffer or chunk is in use; called with _mutex held.
+ */
+void BufferPool::FreeSlabs() {
+    for (std::byte *slab : _slabs) {
+        std::free(slab);
+    }
+    _slabs.clear();
+    _freeBuffers.clear();
+    _freeChunks.clear();
+}
+
+
+void BufferPool::Release(std::byte *data, std::size_t size, bool isTransient) {
+    {
+        const std::lock_guard lock{_mutex};
+        _usedBytes -= size;
+        if (isTransient) {
+            _transientBytes -= size;
+        }
+        const std::size_t cacheSize = (_budget != 0) ? _budget : defaultCacheSize;
+        if ((size == chunkSize) || (size == bufferSize)) {
+            ((size == chunkSize) ? _freeChunks : _freeBuffers).push_back(data);
+            data = nullptr;
+            _pieceBytes -= size;
+            // Slabs are kept whole; drop them all once results are given back, if they exceed the cache.
+            if ((_pieceBytes == 0) && ((_freeBlocks.size() + _slabs.size()) * blockSize > cacheSize)) {
+                FreeSlabs();
+            }
+        } else if ((size == blockSize) && ((_freeBlocks.size() + _slabs.size() + 1) * blockSize <= cacheSize)) {
+            _freeBlocks.push_back(data);
+            data = nullptr;
+        }
+    }
+    std::free(data);
+    _releaseCond.notify_all();
+}
+
+
+void AddrChunkList::Truncate(std::size_t size) {
+    const std::size_t chunkedSize = ChunkedSize();
+    if (size >= chunkedSize) {
+        _spill.resize(std::min(_spill.size(), size - chunkedSize));
+        return;
+    }
+    _spill.clear();
+    const std::size_t chunkCount = (size > inlineCapacity) ? (size - inlineCapacity + chunkCapacity - 1) / chunkCapacity : 0;
+    for (std::size_t i = chunkCount; i < std::min(_chunkCount, inlineChunkCount); ++i) {
+        _inlineChunks[i].Reset();
+    }
+    _moreChunks.erase(_moreChunks.begin() + (std::max(chunkCount, inlineChunkCount) - inlineChunkCount), _moreChunks.end());
+    _chunkCount = chunkCount;
+    if (_chunkCount == 0) {
+        _cursor = _inlineAddrs.data() + size;
+        _chunkEnd = _inlineAddrs.data() + inlineCapacity;
+    } else {
+        _cursor = ChunkBegin(_chunkCount - 1) + (size - inlineCapacity - (_chunkCount - 1) * chunkCapacity);
+        _chunkEnd = ChunkBegin(_chunkCount - 1) + chunkCapacity;
+    }
+}
+
+
+void AddrChunkList::AppendTo(std::vector<std::uint64_t> &addrList) const {
+    addrList.insert(addrList.end(), _inlineAddrs.data(), (_chunkCount == 0) ? _cursor : _inlineAddrs.data() + inlineCapacity);
+    for (std::size_t i = 0; i < _chunkCount; ++i) {
+        const std::uint64_t *begin = ChunkBegin(i);
+        const std::uint64_t *end = (i + 1 < _chunkCount) ? begin + chunkCapacity : _cursor;
+        addrList.insert(addrList.end(), begin, end);
+    }
+    addrList.insert(addrList.end(), _spill.cbegin(), _spill.cend());
+}
+
+
+/**
+ * @return Whether a new chunk was taken; false once the addresses spilled, so they stay in order.
+ */
+bool AddrChunkList::Grow() {
+    if (_isSpilled) {
+        return false;
+    }
+    BufferPool::Block chunk = BufferPool::Instance().TryAcquireChunk();
+    if (!chunk) {
+        _isSpilled = true;
+        return false;
+    }
+    _cursor = reinterpret_cast<std::uint64_t *>(chunk.Data());
+    _chunkEnd = _cursor + chunkCapacity;
+    if (_chunkCount < inlineChunkCount) {
+        _inlineChunks[_chunkCount] = std::move(chunk);
+    } else {
+        _moreChunks.push_back(std::move(chunk));
+    }
+    ++_chunkCount;
+    return true;
+}
+
+} // namespace ame
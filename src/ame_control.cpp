@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_control.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace ame {
+
+static thread_local ScanControl *currentControl = nullptr;
+
+ScanControl *ScanControl::Current() noexcept {
+    return currentControl;
+}
+
+
+ScanControlScope::ScanControlScope(ScanControl &control) noexcept
+    : _previous{currentControl} {
+    currentControl = &control;
+}
+
+
+ScanControlScope::~ScanControlScope() {
+    currentControl = _previous;
+}
+
+
+ScanLimiter::ScanLimiter(ScanControl *control) noexcept
+    : _control{control} {
+    const auto now = std::chrono::steady_clock::now();
+    _deadline = (_control && (_control->timeBudget.count() > 0)) ? now + _control->timeBudget : std::chrono::steady_clock::time_point::max();
+    _lastProgress = now;
+}
+
+
+void ScanLimiter::SetTotalBytes(std::uint64_t totalBytes) noexcept {
+    _totalBytes = totalBytes;
+}
+
+
+bool ScanLimiter::BeginTask(std::uint64_t bytes) noexcept {
+    if (!_control) {
+        return true;
+    }
+    if (_stopReason.load(std::memory_order_relaxed) != ScanStopReason::NONE) {
+        return false;
+    }
+    if (_control->stopToken.stop_requested()) {
+        Stop(ScanStopReason::CANCELLED);
+        return false;
+    }
+    if (std::chrono::steady_clock::now() >= _deadline) {
+        Stop(ScanStopReason::TIME_BUDGET);
+        return false;
+    }
+    if ((_control->maxResults != 0) && (_matchCount.load(std::memory_order_relaxed) >= _control->maxResults)) {
+        Stop(ScanStopReason::MAX_RESULTS);
+        return false;
+    }
+    if (_control->byteBudget != 0) {
+        const std::uint64_t startedBytes = _startedBytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (startedBytes + bytes > _control->byteBudget) {
+            Stop(ScanStopReason::BYTE_BUDGET);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void ScanLimiter::EndTask(std::uint64_t bytes, std::size_t matchCount) {
+    if (!_control) {
+        return;
+    }
+    const std::uint64_t doneBytes = _doneBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    _matchCount.fetch_add(matchCount, std::memory_order_relaxed);
+    if (!_control->progress) {
+        return;
+    }
+    // One call at a time; a worker that finds the lock taken does not wait for it.
+    const std::unique_lock lock{_progressMutex, std::try_to_lock};
+    if (!lock.owns_lock()) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now - _lastProgress >= _control->progressInterval) {
+        _lastProgress = now;
+        _control->progress(doneBytes, _totalBytes);
+    }
+}
+
+
+void ScanLimiter::Finish() {
+    if (!_control) {
+        return;
+    }
+    _control->stopReason = _stopReason.load(std::memory_order_relaxed);
+    _control->doneBytes = _doneBytes.load(std::memory_order_relaxed);
+    _control->totalBytes = _totalBytes;
+    if (_control->progress) {
+        _control->progress(_control->doneBytes, _control->totalBytes);
+    }
+}
+
+
+void ScanLimiter::Stop(ScanStopReason reason) noexcept {
+    // The first reason wins.
+    ScanStopReason expected = ScanStopReason::NONE;
+    _stopReason.compare_exchange_strong(expected, reason, std::memory_order_relaxed);
+}
+
+} // namespace ame
@@ -0,0 +1,719 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_daemon.h"
+#include "ame_logger.h"
+#include "ame_memory.h"
+#include "ame_process.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ame {
+
+static constexpr std::uint32_t maxFrameSize = std::uint32_t{64} << 20;
+static constexpr std::size_t resultsPerFrame = 4096;
+static constexpr std::chrono::milliseconds acceptRetryDelay{100}; // while out of file descriptors or memory
+
+static bool SendAll(int fd, const void *data, std::size_t size) {
+    const auto *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+        const ssize_t nbytes = send(fd, bytes, size, MSG_NOSIGNAL);
+        if (nbytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        bytes += nbytes;
+        size -= nbytes;
+    }
+    return true;
+}
+
+
+static bool RecvAll(int fd, void *data, std::size_t size) {
+    auto *bytes = static_cast<char *>(data);
+    while (size > 0) {
+        const ssize_t nbytes = recv(fd, bytes, size, 0);
+        if (nbytes <= 0) {
+            if ((nbytes < 0) && (errno == EINTR)) {
+                continue;
+            }
+            return false;
+        }
+        bytes += nbytes;
+        size -= nbytes;
+    }
+    return true;
+}
+
+
+static bool SendFrame(int fd, std::uint8_t type, std::string_view payload) {
+    // One send per frame: header and payload together.
+    std::string frame;
+    frame.reserve(sizeof(std::uint32_t) + 1 + payload.size());
+    const auto size = std::uint32_t(1 + payload.size());
+    frame.append(reinterpret_cast<const char *>(&size), sizeof(size));
+    frame += char(type);
+    frame += payload;
+    return SendAll(fd, frame.data(), frame.size());
+}
+
+
+static bool RecvFrame(int fd, std::uint8_t &type, std::string &payload) {
+    std::uint32_t size;
+    if (!RecvAll(fd, &size, sizeof(size)) || (size == 0) || (size > maxFrameSize)) {
+        return false;
+    }
+    if (!RecvAll(fd, &type, 1)) {
+        return false;
+    }
+    payload.resize(size - 1);
+    return RecvAll(fd, payload.data(), payload.size());
+}
+
+
+static bool SendOk(int fd, const MessageWriter &writer) {
+    return SendFrame(fd, std::uint8_t(DaemonStatus::OK), writer.Data());
+}
+
+
+static bool SendError(int fd, std::string_view message) {
+    LOG_WARN("Daemon request failed: {}", message);
+    return SendFrame(fd, std::uint8_t(DaemonStatus::ERROR), MessageWriter{}.PutString(message).Data());
+}
+
+
+static std::uint64_t CountResults(const PidAddrMap &results) {
+    std::uint64_t count = 0;
+    for (const auto &[pid, addrList] : results) {
+        count += addrList.size();
+    }
+    return count;
+}
+
+
+static bool IsValidMemPart(std::uint8_t memPart) {
+    return memPart <= std::uint8_t(MemPart::V);
+}
+
+
+static bool IsValidMatchMode(MatchMode mode) {
+    return (mode == MatchMode::EQUAL) || (mode == MatchMode::RANGE);
+}
+
+
+/**
+ * @return The mem file of pid opened by ATTACH, or nullptr if it is not open.
+ */
+static FileWrapper *FindMemFile(const PidList &pids, std::vector<FileWrapper> &memFiles, pid_t pid) {
+    const auto it = std::ranges::find(pids, pid);
+    if (it == pids.end()) {
+        return nullptr;
+    }
+    FileWrapper &memFile = memFiles[it - pids.begin()];
+    return memFile.IsOpen() ? &memFile : nullptr;
+}
+
+
+Daemon::Daemon(std::string socketPath)
+    : _socketPath{std::move(socketPath)} {}
+
+
+Daemon::~Daemon() {
+    Stop();
+    {
+        std::unique_lock lock{_mutex};
+        for (const int clientFd : _clientFds) {
+            shutdown(clientFd, SHUT_RDWR);
+        }
+        _clientCond.wait(lock, [this] { return _clientFds.empty(); });
+    }
+    _sessions.clear(); // stops the value locks
+}
+
+
+bool Daemon::Run() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (_socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Socket path [{}] is too long.", _socketPath);
+        return false;
+    }
+    std::memcpy(address.sun_path, _socketPath.data(), _socketPath.size());
+
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd == -1) {
+        LOG_ERROR("Failed to create socket: {}.", std::strerror(errno));
+        return false;
+    }
+    unlink(_socketPath.c_str());
+    // Create the socket without access for others, rather than chmod it once it can already be connected to.
+    const mode_t oldMask = umask(077);
+    const bool isBound = bind(listenFd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != -1;
+    umask(oldMask);
+    if (!isBound || (chmod(_socketPath.c_str(), 0600) == -1) || (listen(listenFd, 8) == -1)) {
+        LOG_ERROR("Failed to listen on [{}]: {}.", _socketPath, std::strerror(errno));
+        close(listenFd);
+        return false;
+    }
+    _listenFd = listenFd;
+    LOG_INFO("Daemon listening on [{}].", _socketPath);
+
+    bool isStopped = true;
+    while (true) {
+        const int clientFd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (clientFd == -1) {
+            const int error = errno;
+            if (_isStopping) {
+                break; // shut down by Stop()
+            }
+            if ((error == EBADF) || (error == EINVAL) || (error == ENOTSOCK)) {
+                LOG_ERROR("Failed to accept on [{}]: {}.", _socketPath, std::strerror(error));
+                isStopped = false;
+                break;
+            }
+            if (error != EINTR) {
+                // e.g. ECONNABORTED from a client that gave up, or EMFILE until a client disconnects
+                LOG_WARN("Failed to accept a client: {}.", std::strerror(error));
+            }
+            if ((error == EMFILE) || (error == ENFILE) || (error == ENOBUFS) || (error == ENOMEM)) {
+                std::this_thread::sleep_for(acceptRetryDelay);
+            }
+            continue;
+        }
+        ucred peer{};
+        socklen_t peerSize = sizeof(peer);
+        if ((getsockopt(clientFd, SOL_SOCKET, SO_PEERCRED, &peer, &peerSize) == -1) || (peer.uid != geteuid())) {
+            LOG_WARN("Rejected client of uid {}.", peer.uid);
+            close(clientFd);
+            continue;
+        }
+        const std::lock_guard lock{_mutex};
+        _clientFds.push_back(clientFd);
+        std::thread{[this, clientFd] { ServeClient(clientFd); }}.detach();
+    }
+
+    _listenFd = -1;
+    close(listenFd);
+    unlink(_socketPath.c_str());
+    LOG_INFO("Daemon stopped.");
+    return isStopped;
+}
+
+
+void Daemon::Stop() noexcept {
+    _isStopping = true;
+    const int listenFd = _listenFd.load();
+    if (listenFd != -1) {
+        shutdown(listenFd, SHUT_RDWR);
+    }
+}
+
+
+void Daemon::ServeClient(int clientFd) {
+    std::uint8_t command;
+    std::string payload;
+    while (RecvFrame(clientFd, command, payload)) {
+        MessageReader reader{payload};
+        if (!HandleRequest(clientFd, DaemonCommand(command), reader)) {
+            break; // connection lost
+        }
+    }
+
+    const std::lock_guard lock{_mutex};
+    std::erase(_clientFds, clientFd);
+    close(clientFd);
+    _clientCond.notify_all();
+}
+
+
+std::shared_ptr<Daemon::Session> Daemon::FindSession(std::uint32_t sessionId) {
+    const std::lock_guard lock{_mutex};
+    const auto it = _sessions.find(sessionId);
+    return (it != _sessions.end()) ? it->second : nullptr;
+}
+
+
+/**
+ * @return Whether the response could be sent.
+ */
+bool Daemon::HandleRequest(int clientFd, DaemonCommand command, MessageReader &reader) {
+    if (command == DaemonCommand::ATTACH) {
+        std::uint8_t byName;
+        if (!reader.Get(byName)) {
+            return SendError(clientFd, "Malformed request.");
+        }
+        PidList pids;
+        if (byName) {
+            std::string processName;
+            if (!reader.GetString(processName)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            pids = FindPidsByProcessName(processName);
+        } else {
+            std::uint32_t count;
+            if (!reader.Get(count)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            for (pid_t pid; (pids.size() < count) && reader.Get(pid);) {
+                pids.push_back(pid);
+            }
+        }
+        if (pids.empty()) {
+            return SendError(clientFd, "No process to attach.");
+        }
+
+        auto session = std::make_shared<Session>();
+        session->pids = std::move(pids);
+        for (const pid_t pid : session->pids) {
+            session->memFiles.emplace_back(std::format("/proc/{}/mem", pid), O_RDONLY); // reopened per scan if this fails
+        }
+        const auto pidCount = std::uint32_t(session->pids.size());
+        std::uint32_t sessionId;
+        {
+            const std::lock_guard lock{_mutex};
+            sessionId = _nextSessionId++;
+            _sessions.emplace(sessionId, std::move(session));
+        }
+        LOG_INFO("Session {} attached to {} processes.", sessionId, pidCount);
+        return SendOk(clientFd, MessageWriter{}.Put(sessionId).Put(pidCount));
+    }
+
+    std::uint32_t sessionId;
+    if (!reader.Get(sessionId)) {
+        return SendError(clientFd, "Malformed request.");
+    }
+    if (command == DaemonCommand::DETACH) {
+        std::shared_ptr<Session> session;
+        {
+            const std::lock_guard lock{_mutex};
+            if (const auto it = _sessions.find(sessionId); it != _sessions.end()) {
+                session = std::move(it->second);
+                _sessions.erase(it);
+            }
+        }
+        if (!session) {
+            return SendError(clientFd, std::format("No session {}.", sessionId));
+        }
+        return SendOk(clientFd, {});
+    }
+
+    const std::shared_ptr<Session> session = FindSession(sessionId);
+    if (!session) {
+        return SendError(clientFd, std::format("No session {}.", sessionId));
+    }
+    const std::lock_guard sessionLock{session->mutex};
+
+    switch (command) {
+        case DaemonCommand::SCAN: {
+            ValueType type;
+            std::uint8_t memPart;
+            MatchMode mode;
+            std::uint64_t value, maxValue;
+            if (!reader.Get(type) || !reader.Get(memPart) || !reader.Get(mode) || !reader.Get(value) || !reader.Get(maxValue) || !IsValidMemPart(memPart)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            if (!IsValidMatchMode(mode)) {
+                return SendError(clientFd, std::format("Invalid match mode {}.", std::uint8_t(mode)));
+            }
+            // Reread the regions, which change as the target maps memory, but not reopen the mem files.
+            std::vector<FileWrapper *> memFiles;
+            for (FileWrapper &memFile : session->memFiles) {
+                memFiles.push_back(memFile.IsOpen() ? &memFile : nullptr);
+            }
+            ScanPlan plan = PlanScan(session->pids, MemPart(memPart), RegionOrder::ADDRESS, {}, memFiles);
+            bool isInverted = false;
+            const bool isValid = VisitValueType(type, [&]<typename T>(T) {
+                if (mode == MatchMode::EQUAL) {
+                    session->results = ScanProcesses(plan, sizeof(T), sizeof(std::int32_t), [valueToFind = DecodeValue<T>(value)](const std::byte *data) {
+                        return LoadValue<T>(data) == valueToFind;
+                    });
+                    return;
+                }
+                const T rangeMin = DecodeValue<T>(value);
+                const T rangeMax = DecodeValue<T>(maxValue);
+                if (rangeMin > rangeMax) {
+                    isInverted = true;
+                    return;
+                }
+                session->results = ScanProcesses(plan, sizeof(T), sizeof(std::int32_t), [rangeMin, rangeMax](const std::byte *data) {
+                    const T loaded = LoadValue<T>(data);
+                    return (rangeMin <= loaded) && (loaded <= rangeMax);
+                });
+            });
+            if (!isValid) {
+                return SendError(clientFd, "Invalid value type.");
+            }
+            if (isInverted) {
+                return SendError(clientFd, "Range minimum is greater than its maximum.");
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(CountResults(session->results)));
+        }
+
+        case DaemonCommand::FILTER: {
+            ValueType type;
+            MatchMode mode;
+            std::int64_t offset;
+            std::uint64_t value, maxValue;
+            if (!reader.Get(type) || !reader.Get(mode) || !reader.Get(offset) || !reader.Get(value) || !reader.Get(maxValue)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            if (!IsValidMatchMode(mode)) {
+                return SendError(clientFd, std::format("Invalid match mode {}.", std::uint8_t(mode)));
+            }
+            // Read through the mem files opened by ATTACH, rather than reopen them.
+            std::vector<std::pair<pid_t, std::span<const std::uint64_t>>> lists;
+            std::vector<FileWrapper *> memFiles;
+            for (const auto &[pid, addrList] : session->results) {
+                lists.emplace_back(pid, addrList);
+                memFiles.push_back(FindMemFile(session->pids, session->memFiles, pid));
+            }
+            std::vector<AddrList> filtered;
+            bool isInverted = false;
+            const bool isValid = VisitValueType(type, [&]<typename T>(T) {
+                if (mode == MatchMode::EQUAL) {
+                    filtered = FilterProcesses(lists, memFiles, sizeof(T), offset, [valueToFind = DecodeValue<T>(value)](const std::byte *data) {
+                        return LoadValue<T>(data) == valueToFind;
+                    });
+                    return;
+                }
+                const T rangeMin = DecodeValue<T>(value);
+                const T rangeMax = DecodeValue<T>(maxValue);
+                if (rangeMin > rangeMax) {
+                    isInverted = true;
+                    return;
+                }
+                filtered = FilterProcesses(lists, memFiles, sizeof(T), offset, [rangeMin, rangeMax](const std::byte *data) {
+                    const T loaded = LoadValue<T>(data);
+                    return (rangeMin <= loaded) && (loaded <= rangeMax);
+                });
+            });
+            if (!isValid) {
+                return SendError(clientFd, "Invalid value type.");
+            }
+            if (isInverted) {
+                return SendError(clientFd, "Range minimum is greater than its maximum.");
+            }
+            PidAddrMap results;
+            for (std::size_t i = 0; i < lists.size(); ++i) {
+                results.emplace(lists[i].first, std::move(filtered[i]));
+            }
+            session->results = std::move(results);
+            return SendOk(clientFd, MessageWriter{}.Put(CountResults(session->results)));
+        }
+
+        case DaemonCommand::RESULTS: {
+            std::uint64_t maxCount;
+            if (!reader.Get(maxCount)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            std::uint64_t sentCount = 0;
+            std::vector<std::pair<pid_t, std::uint64_t>> frameResults;
+            frameResults.reserve(resultsPerFrame);
+            auto flush = [&] {
+                MessageWriter frame;
+                frame.Put(std::uint32_t(frameResults.size()));
+                for (const auto &[pid, address] : frameResults) {
+                    frame.Put(pid).Put(address);
+                }
+                frameResults.clear();
+                return SendFrame(clientFd, std::uint8_t(DaemonStatus::MORE), frame.Data());
+            };
+            for (const auto &[pid, addrList] : session->results) {
+                for (const std::uint64_t address : addrList) {
+                    if (sentCount == maxCount) {
+                        break;
+                    }
+                    frameResults.emplace_back(pid, address);
+                    ++sentCount;
+                    if ((frameResults.size() == resultsPerFrame) && !flush()) {
+                        return false;
+                    }
+                }
+            }
+            if (!frameResults.empty() && !flush()) {
+                return false;
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(sentCount));
+        }
+
+        case DaemonCommand::WRITE: {
+            ValueType type;
+            std::uint64_t value;
+            if (!reader.Get(type) || !reader.Get(value)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            std::uint64_t successCount = 0;
+            const bool isValid = VisitValueType(type, [&]<typename T>(T) {
+                for (const auto &[pid, addrList] : session->results) {
+                    if (!addrList.empty()) {
+                        successCount += std::max(WriteAddressGroup(pid, addrList, DecodeValue<T>(value), addrList.size()), 0);
+                    }
+                }
+            });
+            if (!isValid) {
+                return SendError(clientFd, "Invalid value type.");
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(successCount));
+        }
+
+        case DaemonCommand::LOCK: {
+            ValueType type;
+            std::uint64_t value;
+            std::uint32_t intervalMs;
+            if (!reader.Get(type) || !reader.Get(value) || !reader.Get(intervalMs) || (intervalMs == 0)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            const bool isValid = VisitValueType(type, [&]<typename T>(T) {
+                // The lock keeps the results of now, later scans in the session do not move it.
+                session->lockThread = std::jthread{[results = session->results, lockValue = DecodeValue<T>(value), intervalMs](std::stop_token stopToken) {
+                    // Wait on the stop token too, so UNLOCK or DETACH (under the session mutex) does not wait out the interval.
+                    std::mutex waitMutex;
+                    std::condition_variable_any stopCond;
+                    std::unique_lock waitLock{waitMutex};
+                    while (!stopToken.stop_requested()) {
+                        for (const auto &[pid, addrList] : results) {
+                            if (!addrList.empty()) {
+                                WriteAddressGroup(pid, addrList, lockValue, addrList.size());
+                            }
+                        }
+                        stopCond.wait_for(waitLock, stopToken, std::chrono::milliseconds{intervalMs}, [] { return false; });
+                    }
+                }};
+            });
+            if (!isValid) {
+                return SendError(clientFd, "Invalid value type.");
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(CountResults(session->results)));
+        }
+
+        case DaemonCommand::UNLOCK:
+            session->lockThread = {};
+            return SendOk(clientFd, {});
+
+        case DaemonCommand::FREEZE:
+        case DaemonCommand::RESUME: {
+            std::uint64_t successCount = 0;
+            for (const pid_t pid : session->pids) {
+                successCount += (command == DaemonCommand::FREEZE) ? FreezeProcessByPid(pid) : ResumeProcessByPid(pid);
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(successCount));
+        }
+
+        case DaemonCommand::SNAPSHOT_SAVE:
+        case DaemonCommand::SNAPSHOT_LOAD: {
+            std::uint8_t slot;
+            if (!reader.Get(slot)) {
+                return SendError(clientFd, "Malformed request.");
+            }
+            if (command == DaemonCommand::SNAPSHOT_SAVE) {
+                session->snapshots[slot] = session->results;
+            } else {
+                const auto it = session->snapshots.find(slot);
+                if (it == session->snapshots.end()) {
+                    return SendError(clientFd, std::format("No snapshot {}.", slot));
+                }
+                session->results = it->second;
+            }
+            return SendOk(clientFd, MessageWriter{}.Put(CountResults(session->results)));
+        }
+
+        default:
+            return SendError(clientFd, std::format("Unknown command {}.", std::uint8_t(command)));
+    }
+}
+
+
+DaemonClient::~DaemonClient() {
+    if (_fd != -1) {
+        close(_fd);
+    }
+}
+
+
+bool DaemonClient::Connect(std::string_view socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("Socket path [{}] is too long.", socketPath);
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.data(), socketPath.size());
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        LOG_ERROR("Failed to create socket: {}.", std::strerror(errno));
+        return false;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1) {
+        LOG_ERROR("Failed to connect to [{}]: {}.", socketPath, std::strerror(errno));
+        close(fd);
+        return false;
+    }
+    if (_fd != -1) {
+        close(_fd);
+    }
+    _fd = fd;
+    return true;
+}
+
+
+std::optional<std::string> DaemonClient::Call(DaemonCommand command, const MessageWriter &writer, DaemonStatus *status) {
+    if ((_fd == -1) || !SendFrame(_fd, std::uint8_t(command), writer.Data())) {
+        LOG_ERROR("Failed to send request to daemon.");
+        return std::nullopt;
+    }
+    std::uint8_t type;
+    std::string payload;
+    if (!RecvFrame(_fd, type, payload)) {
+        LOG_ERROR("Failed to receive response from daemon.");
+        return std::nullopt;
+    }
+    if (DaemonStatus(type) == DaemonStatus::ERROR) {
+        std::string message;
+        MessageReader{payload}.GetString(message);
+        LOG_ERROR("Daemon error: {}", message);
+        return std::nullopt;
+    }
+    if (status) {
+        *status = DaemonStatus(type);
+    }
+    return payload;
+}
+
+
+std::optional<std::uint64_t> DaemonClient::CallForCount(DaemonCommand command, const MessageWriter &writer) {
+    const auto payload = Call(command, writer);
+    std::uint64_t count;
+    if (!payload.has_value() || !MessageReader{*payload}.Get(count)) {
+        return std::nullopt;
+    }
+    return count;
+}
+
+
+std::optional<std::uint32_t> DaemonClient::Attach(std::string_view processName) {
+    MessageWriter writer;
+    writer.Put(std::uint8_t{1}).PutString(processName);
+    const auto payload = Call(DaemonCommand::ATTACH, writer);
+    std::uint32_t session;
+    if (!payload.has_value() || !MessageReader{*payload}.Get(session)) {
+        return std::nullopt;
+    }
+    return session;
+}
+
+
+std::optional<std::uint32_t> DaemonClient::Attach(const PidList &pids) {
+    MessageWriter writer;
+    writer.Put(std::uint8_t{0}).Put(std::uint32_t(pids.size()));
+    for (const pid_t pid : pids) {
+        writer.Put(pid);
+    }
+    const auto payload = Call(DaemonCommand::ATTACH, writer);
+    std::uint32_t session;
+    if (!payload.has_value() || !MessageReader{*payload}.Get(session)) {
+        return std::nullopt;
+    }
+    return session;
+}
+
+
+bool DaemonClient::Detach(std::uint32_t session) {
+    return Call(DaemonCommand::DETACH, MessageWriter{}.Put(session)).has_value();
+}
+
+
+std::optional<PidAddrMap> DaemonClient::Results(std::uint32_t session, std::uint64_t maxCount) {
+    PidAddrMap result;
+    DaemonStatus status;
+    auto payload = Call(DaemonCommand::RESULTS, MessageWriter{}.Put(session).Put(maxCount), &status);
+    while (payload.has_value() && (status == DaemonStatus::MORE)) {
+        MessageReader reader{*payload};
+        std::uint32_t count = 0;
+        reader.Get(count);
+        pid_t pid;
+        std::uint64_t address;
+        for (std::uint32_t i = 0; (i < count) && reader.Get(pid) && reader.Get(address); ++i) {
+            result[pid].push_back(address);
+        }
+
+        std::uint8_t type;
+        payload.emplace();
+        if (!RecvFrame(_fd, type, *payload)) {
+            LOG_ERROR("Failed to receive response from daemon.");
+            return std::nullopt;
+        }
+        status = DaemonStatus(type);
+    }
+    if (!payload.has_value() || (status != DaemonStatus::OK)) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+
+bool DaemonClient::Unlock(std::uint32_t session) {
+    return Call(DaemonCommand::UNLOCK, MessageWriter{}.Put(session)).has_value();
+}
+
+
+std::optional<std::uint64_t> DaemonClient::Freeze(std::uint32_t session) {
+    return CallForCount(DaemonCommand::FREEZE, MessageWriter{}.Put(session));
+}
+
+
+std::optional<std::uint64_t> DaemonClient::Resume(std::uint32_t session) {
+    return CallForCount(DaemonCommand::RESUME, MessageWriter{}.Put(session));
+}
+
+
+std::optional<std::uint64_t> DaemonClient::SaveSnapshot(std::uint32_t session, std::uint8_t slot) {
+    return CallForCount(DaemonCommand::SNAPSHOT_SAVE, MessageWriter{}.Put(session).Put(slot));
+}
+
+
+std::optional<std::uint64_t> DaemonClient::LoadSnapshot(std::uint32_t session, std::uint8_t slot) {
+    return CallForCount(DaemonCommand::SNAPSHOT_LOAD, MessageWriter{}.Put(session).Put(slot));
+}
+
+} // namespace ame
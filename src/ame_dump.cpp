@@ -0,0 +1,344 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_dump.h"
+#include "ame_file.h"
+#include "ame_logger.h"
+#include "ame_memory.h"
+#include "ame_stats.h"
+#include "ame_thread_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ame {
+
+// Layout of a dump file, in native byte order:
+//   DumpHeader
+//   DumpEntry + path, for each region
+//   padding to a page
+//   content of each region, page aligned
+
+static constexpr std::array<char, 8> dumpMagic = {'A', 'M', 'E', 'D', 'U', 'M', 'P', '\0'};
+static constexpr std::uint32_t dumpVersion = 1;
+static constexpr std::size_t dumpChunkSize = std::size_t{8} << 20; // bytes copied per task
+static constexpr std::uint64_t maxIndexSize = std::uint64_t{64} << 20; // far above any real maps
+
+struct DumpHeader {
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t regionCount;
+    std::uint64_t indexSize; // header and entries, without padding
+};
+
+struct DumpEntry {
+    std::uint64_t beginAddr;
+    std::uint64_t endAddr;
+    std::uint64_t dataOffset;
+    std::array<char, 4> perms;
+    std::uint32_t pathLength;
+};
+
+/**
+ * @brief A shared mapping of a whole file, unmapped on destruction.
+ */
+class FileMapping {
+public:
+    FileMapping(int fd, std::size_t size, int prot)
+        : _size{size} {
+        void *addr = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        _data = (addr == MAP_FAILED) ? nullptr : static_cast<std::byte *>(addr);
+    }
+
+    FileMapping(const FileMapping &) = delete;
+    FileMapping &operator=(const FileMapping &) = delete;
+
+    ~FileMapping() {
+        if (_data) {
+            munmap(_data, _size);
+        }
+    }
+
+    [[nodiscard]] std::byte *Data() const noexcept {
+        return _data;
+    }
+
+protected:
+    std::byte *_data = nullptr;
+    std::size_t _size;
+};
+
+/**
+ * @brief Part of a region copied by one worker.
+ */
+struct CopyTask {
+    std::size_t regionIndex;
+    std::uint64_t offset; // in the region
+    std::uint64_t size;
+};
+
+static std::vector<CopyTask> SplitRegions(const std::vector<DumpRegion> &regions) {
+    std::vector<CopyTask> tasks;
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        const std::uint64_t regionSize = regions[i].region.endAddr - regions[i].region.beginAddr;
+        for (std::uint64_t offset = 0; offset < regionSize; offset += dumpChunkSize) {
+            tasks.push_back({i, offset, std::min<std::uint64_t>(dumpChunkSize, regionSize - offset)});
+        }
+    }
+    return tasks;
+}
+
+
+static std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+
+std::int64_t DumpMemory(pid_t pid, MemPart memPart, std::string_view filePath) {
+    std::vector<DumpRegion> regions;
+    for (MemRegion &region : GetMemRegions(pid, memPart)) {
+        regions.push_back({std::move(region), 0});
+    }
+    if (regions.empty()) {
+        LOG_ERROR("Failed to get address range.");
+        return -1;
+    }
+
+    const std::string memPath = std::format("/proc/{}/mem", pid);
+    FileWrapper memFile{memPath, O_RDONLY};
+    if (!memFile.IsOpen()) {
+        LOG_ERROR("Failed to open [{}].", memPath);
+        return -1;
+    }
+
+    // Index
+    std::string index(sizeof(DumpHeader), '\0');
+    for (const DumpRegion &dumpRegion : regions) {
+        const MemRegion &region = dumpRegion.region;
+        DumpEntry entry{region.beginAddr, region.endAddr, 0, {}, std::uint32_t(region.path.size())};
+        std::memcpy(entry.perms.data(), region.perms.data(), std::min(region.perms.size(), entry.perms.size()));
+        index.append(reinterpret_cast<const char *>(&entry), sizeof(entry));
+        index += region.path;
+    }
+    const std::uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    std::uint64_t fileSize = AlignUp(index.size(), pageSize);
+    std::size_t entryPos = sizeof(DumpHeader);
+    for (DumpRegion &dumpRegion : regions) {
+        dumpRegion.dataOffset = fileSize;
+        std::memcpy(&index[entryPos + offsetof(DumpEntry, dataOffset)], &fileSize, sizeof(fileSize));
+        entryPos += sizeof(DumpEntry) + dumpRegion.region.path.size();
+        fileSize += AlignUp(dumpRegion.region.endAddr - dumpRegion.region.beginAddr, pageSize);
+    }
+    const DumpHeader header{dumpMagic, dumpVersion, std::uint32_t(regions.size()), index.size()};
+    std::memcpy(index.data(), &header, sizeof(header));
+
+    // The content is read from the mem file straight into the page cache of the dump file.
+    // (/proc/<pid>/mem supports neither splice nor copy_file_range.)
+    FileWrapper dumpFile{filePath, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644};
+    if (!dumpFile.IsOpen()) {
+        LOG_ERROR("Failed to open [{}]: {}.", filePath, std::strerror(errno));
+        return -1;
+    }
+    // Reserve every block now: a write fault on a full file system would raise SIGBUS in the mapping.
+    if (const int error = posix_fallocate64(dumpFile.GetFd(), 0, off64_t(fileSize)); error != 0) {
+        LOG_ERROR("Failed to allocate {} bytes for [{}]: {}.", fileSize, filePath, std::strerror(error));
+        return -1;
+    }
+    const FileMapping mapping{dumpFile.GetFd(), fileSize, PROT_READ | PROT_WRITE};
+    if (!mapping.Data()) {
+        LOG_ERROR("Failed to map [{}]: {}.", filePath, std::strerror(errno));
+        return -1;
+    }
+    std::memcpy(mapping.Data(), index.data(), index.size());
+
+    LOG_INFO("Dump {} regions of process {} to [{}] start.", regions.size(), pid, filePath);
+    const std::vector<CopyTask> tasks = SplitRegions(regions);
+    std::vector<std::uint64_t> taskBytes(tasks.size());
+    ThreadPool::Instance().ParallelFor(tasks.size(), [&](std::size_t taskIndex) {
+        const CopyTask &task = tasks[taskIndex];
+        const DumpRegion &dumpRegion = regions[task.regionIndex];
+        std::byte *const dest = mapping.Data() + dumpRegion.dataOffset + task.offset;
+        const std::uint64_t beginAddr = dumpRegion.region.beginAddr + task.offset;
+        for (std::uint64_t done = 0; done < task.size;) {
+            const ssize_t nbytes = ReadMem(memFile, dest + done, task.size - done, beginAddr + done);
+            if (nbytes > 0) {
+                done += nbytes;
+                taskBytes[taskIndex] += nbytes;
+            } else {
+                done = AlignUp(done + 1, pageSize); // unreadable page, leave the hole
+            }
+        }
+    });
+
+    std::int64_t totalBytes = 0;
+    for (const std::uint64_t bytes : taskBytes) {
+        totalBytes += std::int64_t(bytes);
+    }
+    LOG_INFO("Dump end, {} bytes.", totalBytes);
+    return totalBytes;
+}
+
+
+/**
+ * @return Whether [beginAddr, endAddr) is a valid range with its content at dataOffset within a file of fileSize.
+ */
+static bool IsInFile(std::uint64_t beginAddr, std::uint64_t endAddr, std::uint64_t dataOffset, std::uint64_t fileSize) {
+    if (endAddr < beginAddr) {
+        return false;
+    }
+    const std::uint64_t size = endAddr - beginAddr;
+    return (size <= fileSize) && (dataOffset <= fileSize - size); // not dataOffset + size, which can wrap around
+}
+
+
+std::vector<DumpRegion> ReadDumpIndex(std::string_view filePath) {
+    std::vector<DumpRegion> result;
+
+    FileWrapper dumpFile{filePath, O_RDONLY | O_CLOEXEC};
+    if (!dumpFile.IsOpen()) {
+        LOG_ERROR("Failed to open [{}].", filePath);
+        return result;
+    }
+
+    DumpHeader header;
+    if ((dumpFile.PRead64(&header, sizeof(header), 0) != sizeof(header)) || (header.magic != dumpMagic)) {
+        LOG_ERROR("[{}] is not a dump file.", filePath);
+        return result;
+    }
+    if (header.version != dumpVersion) {
+        LOG_ERROR("Unsupported version {} of dump file [{}].", header.version, filePath);
+        return result;
+    }
+
+    struct stat64 fileStat;
+    if (fstat64(dumpFile.GetFd(), &fileStat) == -1) {
+        LOG_ERROR("Failed to stat [{}]: {}.", filePath, std::strerror(errno));
+        return result;
+    }
+    if ((header.indexSize < sizeof(DumpHeader)) || (header.indexSize > std::uint64_t(fileStat.st_size)) || (header.indexSize > maxIndexSize)) {
+        LOG_ERROR("Invalid index size {} of [{}].", header.indexSize, filePath);
+        return result;
+    }
+
+    std::string index(header.indexSize, '\0');
+    if (dumpFile.PRead64(index.data(), index.size(), 0) != std::int64_t(index.size())) {
+        LOG_ERROR("Failed to read index of [{}].", filePath);
+        return result;
+    }
+    std::size_t entryPos = sizeof(DumpHeader);
+    for (std::uint32_t i = 0; i < header.regionCount; ++i) {
+        DumpEntry entry;
+        if (entryPos + sizeof(entry) > index.size()) {
+            LOG_ERROR("Index of [{}] is truncated.", filePath);
+            return {};
+        }
+        std::memcpy(&entry, &index[entryPos], sizeof(entry));
+        entryPos += sizeof(entry);
+        if (entryPos + entry.pathLength > index.size()) {
+            LOG_ERROR("Index of [{}] is truncated.", filePath);
+            return {};
+        }
+        if (!IsInFile(entry.beginAddr, entry.endAddr, entry.dataOffset, fileStat.st_size)) {
+            LOG_ERROR("Invalid region [{:#x}, {:#x}) at offset {} of [{}].", entry.beginAddr, entry.endAddr, entry.dataOffset, filePath);
+            return {};
+        }
+        MemRegion region{entry.beginAddr, entry.endAddr, {entry.perms.data(), entry.perms.size()}, index.substr(entryPos, entry.pathLength)};
+        entryPos += entry.pathLength;
+        result.push_back({std::move(region), entry.dataOffset});
+    }
+    return result;
+}
+
+
+std::int64_t RestoreMemory(pid_t pid, std::string_view filePath) {
+    const std::vector<DumpRegion> regions = ReadDumpIndex(filePath);
+    if (regions.empty()) {
+        return -1;
+    }
+
+    FileWrapper dumpFile{filePath, O_RDONLY | O_CLOEXEC};
+    struct stat64 fileStat;
+    if (!dumpFile.IsOpen() || (fstat64(dumpFile.GetFd(), &fileStat) == -1)) {
+        LOG_ERROR("Failed to open [{}].", filePath);
+        return -1;
+    }
+    const std::uint64_t fileSize = fileStat.st_size;
+    for (const DumpRegion &dumpRegion : regions) {
+        if (!IsInFile(dumpRegion.region.beginAddr, dumpRegion.region.endAddr, dumpRegion.dataOffset, fileSize)) {
+            LOG_ERROR("Dump file [{}] is truncated.", filePath);
+            return -1;
+        }
+    }
+    const FileMapping mapping{dumpFile.GetFd(), fileSize, PROT_READ};
+    if (!mapping.Data()) {
+        LOG_ERROR("Failed to map [{}]: {}.", filePath, std::strerror(errno));
+        return -1;
+    }
+    madvise(mapping.Data(), fileSize, MADV_SEQUENTIAL);
+
+    const std::string memPath = std::format("/proc/{}/mem", pid);
+    FileWrapper memFile{memPath, O_WRONLY};
+    if (!memFile.IsOpen()) {
+        LOG_ERROR("Failed to open [{}].", memPath);
+        return -1;
+    }
+
+    LOG_INFO("Restore {} regions of process {} from [{}] start.", regions.size(), pid, filePath);
+    const std::vector<CopyTask> tasks = SplitRegions(regions);
+    std::vector<std::uint64_t> taskBytes(tasks.size());
+    ThreadPool::Instance().ParallelFor(tasks.size(), [&](std::size_t taskIndex) {
+        const CopyTask &task = tasks[taskIndex];
+        const DumpRegion &dumpRegion = regions[task.regionIndex];
+        const std::byte *const src = mapping.Data() + dumpRegion.dataOffset + task.offset;
+        const std::uint64_t beginAddr = dumpRegion.region.beginAddr + task.offset;
+        for (std::uint64_t done = 0; done < task.size;) {
+            const ssize_t nbytes = WriteMem(memFile, src + done, task.size - done, beginAddr + done);
+            if (nbytes > 0) {
+                done += nbytes;
+                taskBytes[taskIndex] += nbytes;
+            } else {
+                done = AlignUp(done + 1, sysconf(_SC_PAGESIZE)); // unmapped or read-only now
+            }
+        }
+    });
+
+    std::int64_t totalBytes = 0;
+    for (const std::uint64_t bytes : taskBytes) {
+        totalBytes += std::int64_t(bytes);
+    }
+    LOG_INFO("Restore end, {} bytes.", totalBytes);
+    return totalBytes;
+}
+
+} // namespace ame
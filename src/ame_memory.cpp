@@ -19,16 +19,24 @@
 
 #include "ame_memory.h"
 #include "ame_logger.h"
+#include "ame_stats.h"
 
+#include <fcntl.h>
 #include <sys/types.h>
+#include <unistd.h>
 
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
 
+#include <algorithm>
 #include <format>
 #include <fstream>
+#include <numeric>
+#include <span>
+#include <sstream>
 #include <string>
+#include <vector>
 
 namespace ame {
 
@@ -66,8 +74,11 @@ bool IsAreaBelongToPart(MemPart memPart, const std::string &vmAreaStr) {
 }
 
 
-AddrRangeList GetAddrRange(pid_t pid, MemPart memPart) {
-    AddrRangeList result;
+/**
+ * @brief Get the readable and writable regions of a process in the partition, with their permissions and paths.
+ */
+std::vector<MemRegion> GetMemRegions(pid_t pid, MemPart memPart) {
+    std::vector<MemRegion> result;
 
     const std::string mapsPath = std::format("/proc/{}/maps", pid);
     std::ifstream mapsFile{mapsPath};
@@ -80,10 +91,147 @@ AddrRangeList GetAddrRange(pid_t pid, MemPart memPart) {
         if (line.find("rw") > 27 || !IsAreaBelongToPart(memPart, line)) {
             continue; // 27 -> the max columns of vm_flags
         }
+        // e.g. "7f0e4c000000-7f0e4c021000 rw-p 00000000 00:00 0    [anon:libc_malloc]"
         std::size_t hyphenPos;
         const std::uint64_t startAddr = std::stoull(line, &hyphenPos, 16);
-        const std::uint64_t endAddr = std::strtoull(&line[hyphenPos + 1], nullptr, 16);
-        result.emplace_back(startAddr, endAddr);
+        char *permsPos;
+        const std::uint64_t endAddr = std::strtoull(&line[hyphenPos + 1], &permsPos, 16);
+        std::istringstream fields{permsPos};
+        std::string perms, offset, device, inode;
+        fields >> perms >> offset >> device >> inode >> std::ws;
+        std::string path;
+        std::getline(fields, path);
+        result.push_back({startAddr, endAddr, std::move(perms), std::move(path)});
+    }
+    return result;
+}
+
+
+AddrRangeList GetAddrRange(pid_t pid, MemPart memPart) {
+    AddrRangeList result;
+    for (const MemRegion &region : GetMemRegions(pid, memPart)) {
+        result.emplace_back(region.beginAddr, region.endAddr);
+    }
+    return result;
+}
+
+
+/**
+ * @return Index of the first partition in partPriority that the region belongs to, or partPriority.size().
+ */
+static std::size_t GetPartRank(const MemRegion &region, std::span<const MemPart> partPriority) {
+    for (std::size_t i = 0; i < partPriority.size(); ++i) {
+        // A_ANONMYOURS is judged by the length of the whole maps line, which means a line without path.
+        const bool isInPart = (partPriority[i] == MemPart::A_ANONMYOURS) ? region.path.empty() : IsAreaBelongToPart(partPriority[i], region.path);
+        if (isInPart) {
+            return i;
+        }
+    }
+    return partPriority.size();
+}
+
+
+/**
+ * @brief Get the regions of each process and split them into tasks of at most scanChunkSize bytes.
+ *
+ * A process that could not be read is left out, with an error logged.
+ */
+ScanPlan PlanScan(const PidList &pids, MemPart memPart, RegionOrder regionOrder, std::span<const MemPart> partPriority,
+                  std::span<FileWrapper *const> memFiles) {
+    ScanPlan plan;
+    plan.openedFiles.reserve(pids.size()); // plan.memFiles point into it
+    std::vector<std::uint64_t> taskKeys;   // for regionOrder, the same for all tasks of a region
+    for (std::size_t i = 0; i < pids.size(); ++i) {
+        const pid_t pid = pids[i];
+        const std::vector<MemRegion> regions = GetMemRegions(pid, memPart);
+        if (regions.empty()) {
+            LOG_ERROR("Failed to get address range of process {}.", pid);
+            continue;
+        }
+
+        FileWrapper *memFile = (i < memFiles.size()) ? memFiles[i] : nullptr;
+        if (!memFile) {
+            const std::string memPath = std::format("/proc/{}/mem", pid);
+            memFile = &plan.openedFiles.emplace_back(memPath, O_RDONLY);
+            if (!memFile->IsOpen()) {
+                LOG_ERROR("Failed to open [{}].", memPath);
+                continue;
+            }
+        }
+
+        const std::size_t procIndex = plan.pids.size();
+        plan.pids.push_back(pid);
+        plan.memFiles.push_back(memFile);
+        for (const MemRegion &region : regions) {
+            std::uint64_t key = 0;
+            if (regionOrder == RegionOrder::SMALLEST_FIRST) {
+                key = region.endAddr - region.beginAddr;
+            } else if (regionOrder == RegionOrder::PART_PRIORITY) {
+                key = GetPartRank(region, partPriority);
+            }
+            plan.totalBytes += region.endAddr - region.beginAddr;
+            for (std::uint64_t address = region.beginAddr; address < region.endAddr; address += scanChunkSize) {
+                plan.tasks.push_back({procIndex, address, std::min(address + scanChunkSize, region.endAddr), region.endAddr});
+                taskKeys.push_back(key);
+            }
+        }
+    }
+
+    plan.order.resize(plan.tasks.size());
+    std::iota(plan.order.begin(), plan.order.end(), std::size_t{0});
+    if (regionOrder != RegionOrder::ADDRESS) {
+        std::ranges::stable_sort(plan.order, {}, [&taskKeys](std::size_t taskIndex) { return taskKeys[taskIndex]; });
+    }
+    return plan;
+}
+
+
+bool TrimTaskResults(std::vector<AddrChunkList> &taskResults, std::span<const std::size_t> order, std::size_t maxResults) {
+    if (maxResults == 0) {
+        return false;
+    }
+    bool isTrimmed = false;
+    std::size_t remaining = maxResults;
+    for (const std::size_t taskIndex : order) {
+        AddrChunkList &taskResult = taskResults[taskIndex];
+        if (taskResult.Size() > remaining) {
+            taskResult.Truncate(remaining);
+            isTrimmed = true;
+        }
+        remaining -= taskResult.Size();
+    }
+    return isTrimmed;
+}
+
+
+/**
+ * @brief PRead64 on a mem file, counted in ThreadScanCounters().
+ */
+ssize_t ReadMem(FileWrapper &memFile, void *buf, std::size_t nbytes, std::uint64_t address) {
+    const ssize_t result = memFile.PRead64(buf, nbytes, address);
+    ScanCounters &counters = ThreadScanCounters();
+    ++counters.syscallCount;
+    if (result < 0) {
+        ++counters.failedReadCount;
+    } else {
+        counters.bytesRead += result;
+        counters.shortReadCount += (std::size_t(result) < nbytes);
+    }
+    return result;
+}
+
+
+/**
+ * @brief PWrite64 on a mem file, counted in ThreadScanCounters().
+ */
+ssize_t WriteMem(FileWrapper &memFile, const void *buf, std::size_t n, std::uint64_t address) {
+    const ssize_t result = memFile.PWrite64(buf, n, address);
+    ScanCounters &counters = ThreadScanCounters();
+    ++counters.syscallCount;
+    if (result < 0) {
+        ++counters.failedWriteCount;
+    } else {
+        counters.bytesWritten += result;
     }
     return result;
 }
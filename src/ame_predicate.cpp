@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_predicate.h"
+#include "ame_logger.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ame {
+
+/**
+ * @brief Recursive descent parser of a predicate, one instance per expression.
+ */
+class PredicateParser {
+public:
+    explicit PredicateParser(std::string_view expression)
+        : _expression{expression} {}
+
+    std::optional<PredicateAst> Parse() {
+        const std::uint32_t root = ParseOr();
+        SkipSpace();
+        if (_failed || (_pos != _expression.size())) {
+            LOG_ERROR("Invalid predicate \"{}\" at column {}.", _expression, _pos + 1);
+            return std::nullopt;
+        }
+        AsCondition(root);
+        return std::move(_ast);
+    }
+
+protected:
+    using Op = PredicateAst::Op;
+
+    void SkipSpace() {
+        while ((_pos < _expression.size()) && std::isspace(std::uint8_t(_expression[_pos]))) {
+            ++_pos;
+        }
+    }
+
+    bool Accept(std::string_view token) {
+        SkipSpace();
+        if (!_expression.substr(_pos).starts_with(token)) {
+            return false;
+        }
+        // "<" must not take the head of "<<" or "<=", "&" the head of "&&", and so on
+        const std::size_t next = _pos + token.size();
+        if ((token.size() == 1) && (next < _expression.size())) {
+            const char c = _expression[next];
+            if (((token[0] == '<') || (token[0] == '>')) && ((c == token[0]) || (c == '='))) {
+                return false;
+            }
+            if (((token[0] == '&') || (token[0] == '|')) && (c == token[0])) {
+                return false;
+            }
+            if (((token[0] == '!') || (token[0] == '=')) && (c == '=')) {
+                return false;
+            }
+        }
+        _pos = next;
+        return true;
+    }
+
+    std::uint32_t Add(PredicateAst::Node node) {
+        _ast.nodes.push_back(node);
+        return std::uint32_t(_ast.nodes.size() - 1);
+    }
+
+    std::uint32_t AddOp(Op op, std::uint32_t left, std::uint32_t right = 0) {
+        return Add({.op = op, .left = left, .right = right});
+    }
+
+    // A number where a condition is expected means != 0.
+    std::uint32_t AsCondition(std::uint32_t index) {
+        if (_failed || (index >= _ast.nodes.size())) {
+            _failed = true; // a missing operand, e.g. in "!" or "|| 1"
+            return 0;
+        }
+        if (PredicateAst::IsCondition(_ast.nodes[index].op)) {
+            return index;
+        }
+        return AddOp(Op::TO_BOOL, index);
+    }
+
+    std::uint32_t ParseOr() {
+        std::uint32_t left = ParseAnd();
+        while (Accept("||")) {
+            left = AsCondition(left);
+            const std::uint32_t right = AsCondition(ParseAnd());
+            left = AddOp(Op::OR, left, right);
+        }
+        return left;
+    }
+
+    std::uint32_t ParseAnd() {
+        std::uint32_t left = ParseNot();
+        while (Accept("&&")) {
+            left = AsCondition(left);
+            const std::uint32_t right = AsCondition(ParseNot());
+            left = AddOp(Op::AND, left, right);
+        }
+        return left;
+    }
+
+    std::uint32_t ParseNot() {
+        if (Accept("!")) {
+            return AddOp(Op::NOT, AsCondition(ParseNot()));
+        }
+        return ParseCompare();
+    }
+
+    std::uint32_t ParseCompare() {
+        static constexpr std::pair<std::string_view, Op> compareOps[] = {
+            {"==", Op::EQ}, {"!=", Op::NE}, {"<=", Op::LE}, {">=", Op::GE}, {"<", Op::LT}, {">", Op::GT},
+        };
+        const std::uint32_t left = ParseSum();
+        for (const auto &[token, op] : compareOps) {
+            if (Accept(token)) {
+                const std::uint32_t right = ParseSum();
+                return AddOp(op, left, right);
+            }
+        }
+        return left;
+    }
+
+    std::uint32_t ParseSum() {
+        static constexpr std::pair<std::string_view, Op> sumOps[] = {
+            {"+", Op::ADD}, {"-", Op::SUB}, {"|", Op::BIT_OR}, {"^", Op::BIT_XOR},
+        };
+        std::uint32_t left = ParseProduct();
+        for (bool found = true; found && !_failed;) {
+            found = false;
+            for (const auto &[token, op] : sumOps) {
+                if (Accept(token)) {
+                    const std::uint32_t right = ParseProduct();
+                    left = AddOp(op, left, right);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        return left;
+    }
+
+    std::uint32_t ParseProduct() {
+        static constexpr std::pair<std::string_view, Op> productOps[] = {
+            {"*", Op::MUL}, {"/", Op::DIV}, {"%", Op::MOD}, {"<<", Op::SHL}, {">>", Op::SHR}, {"&", Op::BIT_AND},
+        };
+        std::uint32_t left = ParseUnary();
+        for (bool found = true; found && !_failed;) {
+            found = false;
+            for (const auto &[token, op] : productOps) {
+                if (Accept(token)) {
+                    const std::uint32_t right = ParseUnary();
+                    left = AddOp(op, left, right);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        return left;
+    }
+
+    std::uint32_t ParseUnary() {
+        if (_failed) {
+            return 0;
+        }
+        if (Accept("-")) {
+            return AddOp(Op::NEG, ParseUnary());
+        }
+        if (Accept("~")) {
+            return AddOp(Op::BIT_NOT, ParseUnary());
+        }
+        if (Accept("(")) {
+            const std::uint32_t inner = ParseOr();
+            if (!Accept(")")) {
+                _failed = true;
+            }
+            return inner;
+        }
+        if (Accept("value")) {
+            return Add({.op = Op::VALUE});
+        }
+        return ParseNumber();
+    }
+
+    std::uint32_t ParseNumber() {
+        SkipSpace();
+        const std::string rest(_expression.substr(_pos));
+        const char *begin = rest.c_str();
+        char *end = nullptr;
+        PredicateAst::Node node{.op = Op::CONST};
+        if (rest.starts_with("0x") || rest.starts_with("0X")) {
+            node.intConstant = std::int64_t(std::strtoull(begin, &end, 16));
+        } else {
+            const std::size_t length = rest.find_first_not_of("0123456789");
+            if ((length < rest.size()) && ((rest[length] == '.') || (rest[length] == 'e') || (rest[length] == 'E'))) {
+                node.floatConstant = std::strtod(begin, &end);
+                node.intConstant = std::int64_t(node.floatConstant);
+                node.isFloatConstant = true;
+            } else {
+                node.intConstant = std::int64_t(std::strtoull(begin, &end, 10));
+            }
+        }
+        if (end == begin) {
+            _failed = true;
+            return 0;
+        }
+        _pos += std::size_t(end - begin);
+        return Add(node);
+    }
+
+    std::string_view _expression;
+    std::size_t _pos = 0;
+    bool _failed = false;
+    PredicateAst _ast;
+};
+
+
+std::optional<PredicateAst> ParsePredicate(std::string_view expression) {
+    return PredicateParser{expression}.Parse();
+}
+
+} // namespace ame
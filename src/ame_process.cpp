@@ -18,64 +18,238 @@
  */
 
 #include "ame_process.h"
+#include "ame_file.h"
 #include "ame_logger.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <sys/types.h>
 
-#include <cctype>
 #include <cerrno>
 #include <csignal>
-#include <cstdlib>
 #include <cstring>
 
 #include <algorithm>
+#include <charconv>
 #include <format>
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <regex>
 #include <string>
 #include <thread>
+#include <unordered_set>
 
 namespace ame {
 
 /**
- * @brief Find the PID of a process by its name.
- * @param [in] processName  Process name, which could be package name for Android app.
- * @return The std::optional with value of the PID, or std::nullopt if it could not be found.
+ * @brief Read the process name (argv[0]) from "<pid>/cmdline" relative to DIRFD.
+ * @return The name, or std::nullopt if the process has exited.
  */
-std::optional<pid_t> FindPidByProcessName(std::string_view processName) {
+static std::optional<std::string> ReadProcessName(int dirFd, std::string_view pidStr) {
+    const std::string cmdlinePath = std::format("{}/cmdline", pidStr);
+    FileWrapper cmdlineFile{dirFd, cmdlinePath, O_RDONLY | O_CLOEXEC};
+    if (!cmdlineFile.IsOpen()) {
+        return std::nullopt;
+    }
+
+    // Android process names are limited to well below this, longer argv[0] are truncated.
+    char buffer[256];
+    const ssize_t nbytes = cmdlineFile.Read(buffer, sizeof(buffer));
+    if (nbytes < 0) {
+        return std::nullopt;
+    }
+    const std::string_view content{buffer, std::size_t(nbytes)};
+    return std::string{content.substr(0, content.find('\0'))};
+}
+
+
+static std::optional<pid_t> ParsePid(std::string_view str) {
+    pid_t pid;
+    const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), pid);
+    if ((ec != std::errc{}) || (ptr != str.data() + str.size())) {
+        return std::nullopt;
+    }
+    return pid;
+}
+
+
+/**
+ * @brief Whether a name may still change, as an app forked from zygote gets its name only after it starts.
+ * @note An empty name is final: kernel threads and zombies have an empty cmdline for as long as they live.
+ */
+static bool IsProvisionalName(std::string_view name) {
+    return name.starts_with("zygote") || name.starts_with("usap") || (name == "<pre-initialized>");
+}
+
+
+bool ProcessTable::Refresh(bool full) {
     static constexpr char procPath[] = "/proc";
     std::unique_ptr<DIR, decltype(&closedir)> procDir{opendir(procPath), &closedir};
     if (!procDir) {
         LOG_ERROR("Failed to open [{}].", procPath);
-        return std::nullopt;
+        return false;
     }
+    const int procFd = dirfd(procDir.get());
 
-    std::string cmdline;
+    std::unordered_set<pid_t> alivePids;
+    alivePids.reserve(_nameByPid.size());
     for (const dirent *entry; (entry = readdir(procDir.get())) != nullptr;) {
         if (entry->d_type != DT_DIR) {
             continue; // not a directory
         }
         const std::string_view dirname{entry->d_name};
-        if (!std::all_of(dirname.cbegin(), dirname.cend(), &::isdigit)) {
+        const auto pidOpt = ParsePid(dirname);
+        if (!pidOpt.has_value()) {
             continue;
         }
+        const pid_t pid = *pidOpt;
 
-        const std::string cmdlinePath = std::format("/proc/{}/cmdline", dirname);
-        std::ifstream cmdlineFile{cmdlinePath};
-        if (!cmdlineFile.is_open()) {
-            LOG_ERROR("Failed to open [{}].", cmdlinePath);
+        if (const auto it = _nameByPid.find(pid); !full && (it != _nameByPid.end()) && !IsProvisionalName(it->second)) {
+            alivePids.insert(pid);
             continue;
         }
-        std::getline(cmdlineFile, cmdline, '\0');
-        if (cmdline == processName) {
-            return std::atoi(dirname.data());
+        auto nameOpt = ReadProcessName(procFd, dirname);
+        if (!nameOpt.has_value()) {
+            continue; // exited
         }
+        Erase(pid);
+        Insert(pid, std::move(*nameOpt));
+        alivePids.insert(pid);
     }
-    return std::nullopt;
+
+    std::erase_if(_nameByPid, [this, &alivePids](const auto &item) {
+        if (alivePids.contains(item.first)) {
+            return false;
+        }
+        std::erase(_pidsByName[item.second], item.first);
+        return true;
+    });
+    std::erase_if(_pidsByName, [](const auto &item) { return item.second.empty(); });
+    LOG_DEBUG("Process table refreshed, {} processes.", _nameByPid.size());
+    return true;
+}
+
+
+/**
+ * @brief Re-read the name of a single process.
+ * @return Whether the process is still alive with the same name.
+ */
+bool ProcessTable::Validate(pid_t pid) {
+    const auto it = _nameByPid.find(pid);
+    auto nameOpt = ReadProcessName(AT_FDCWD, std::format("/proc/{}", pid));
+    if ((it != _nameByPid.end()) && nameOpt.has_value() && (it->second == *nameOpt)) {
+        return true;
+    }
+    Erase(pid);
+    if (nameOpt.has_value()) {
+        Insert(pid, std::move(*nameOpt));
+    }
+    return false;
+}
+
+
+void ProcessTable::Clear() noexcept {
+    _nameByPid.clear();
+    _pidsByName.clear();
+}
+
+
+PidList ProcessTable::FindPids(std::string_view processName, bool withSubProcess) const {
+    PidList result;
+    if (processName.empty()) {
+        return result;
+    }
+
+    // Sub-processes are named "<name>:<suffix>", so they follow "<name>" directly in the ordered index.
+    for (auto it = _pidsByName.lower_bound(processName); it != _pidsByName.cend(); ++it) {
+        const std::string_view name = it->first;
+        const bool isSelf = (name == processName);
+        const bool isSubProcess = withSubProcess && name.starts_with(processName) && (name.size() > processName.size()) && (name[processName.size()] == ':');
+        if (!isSelf && !isSubProcess) {
+            if (!name.starts_with(processName)) {
+                break;
+            }
+            continue; // e.g. "com.example.foo" for "com.example"
+        }
+        result.insert(result.end(), it->second.cbegin(), it->second.cend());
+    }
+    return result;
+}
+
+
+std::optional<std::string> ProcessTable::GetName(pid_t pid) const {
+    const auto it = _nameByPid.find(pid);
+    if (it == _nameByPid.cend()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+
+void ProcessTable::Insert(pid_t pid, std::string name) {
+    PidList &pids = _pidsByName[name];
+    pids.insert(std::upper_bound(pids.begin(), pids.end(), pid), pid);
+    _nameByPid.emplace(pid, std::move(name));
+}
+
+
+void ProcessTable::Erase(pid_t pid) {
+    const auto it = _nameByPid.find(pid);
+    if (it == _nameByPid.end()) {
+        return;
+    }
+    if (const auto pidsIt = _pidsByName.find(it->second); pidsIt != _pidsByName.end()) {
+        std::erase(pidsIt->second, pid);
+        if (pidsIt->second.empty()) {
+            _pidsByName.erase(pidsIt);
+        }
+    }
+    _nameByPid.erase(it);
+}
+
+
+/**
+ * @brief Find the PIDs of a process by its name, through a process table shared by the whole library.
+ *
+ * The table is refreshed incrementally on each call. A PID found in it is checked against its cmdline again,
+ * since Android apps are renamed after being forked from zygote and PIDs are reused; if any check fails or
+ * nothing is found, the table is rebuilt once.
+ *
+ * @param [in] processName  Process name, which could be package name for Android app.
+ * @param [in] withSubProcess  Also return sub-processes, e.g. "com.example:remote".
+ */
+PidList FindPidsByProcessName(std::string_view processName, bool withSubProcess) {
+    static std::mutex tableMutex;
+    static ProcessTable table;
+    const std::lock_guard lock{tableMutex};
+
+    if (!table.Refresh()) {
+        return {};
+    }
+    PidList result = table.FindPids(processName, withSubProcess);
+    const bool isStale = !std::all_of(result.cbegin(), result.cend(), [](pid_t pid) { return table.Validate(pid); });
+    if (result.empty() || isStale) {
+        table.Refresh(true);
+        result = table.FindPids(processName, withSubProcess);
+    }
+    return result;
+}
+
+
+/**
+ * @brief Find the PID of a process by its name.
+ * @param [in] processName  Process name, which could be package name for Android app.
+ * @return The std::optional with value of the PID, or std::nullopt if it could not be found.
+ */
+std::optional<pid_t> FindPidByProcessName(std::string_view processName) {
+    const PidList pids = FindPidsByProcessName(processName, false);
+    if (pids.empty()) {
+        return std::nullopt;
+    }
+    return pids.front();
 }
 
 
@@ -155,17 +329,22 @@ bool ResumeProcessByPid(pid_t pid) {
 
 
 /**
+ * @brief Apply the operation to the process and all its sub-processes.
  * @retval 0  The operation succeeded.
  * @retval -1  Could not find the process.
- * @retval -2  The operation failed.
+ * @retval -2  The operation failed for at least one process.
  */
 int DoWithProcessName(std::string_view processName, std::function<bool(pid_t)> operation) {
-    const auto pidOpt = FindPidByProcessName(processName);
-    if (!pidOpt.has_value()) {
+    const PidList pids = FindPidsByProcessName(processName);
+    if (pids.empty()) {
         LOG_ERROR("Cannot find process '{}'.", processName);
         return -1;
     }
-    return operation(*pidOpt) ? 0 : -2;
+    bool isAllSucceeded = true;
+    for (const pid_t pid : pids) {
+        isAllSucceeded &= operation(pid);
+    }
+    return isAllSucceeded ? 0 : -2;
 }
 
 int FreezeProcessByName(std::string_view processName) {
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_stats.h"
+
+#include <format>
+#include <iterator>
+#include <string>
+
+namespace ame {
+
+ScanCounters &ScanCounters::operator+=(const ScanCounters &other) noexcept {
+    syscallCount += other.syscallCount;
+    bytesRead += other.bytesRead;
+    bytesWritten += other.bytesWritten;
+    shortReadCount += other.shortReadCount;
+    failedReadCount += other.failedReadCount;
+    failedWriteCount += other.failedWriteCount;
+    return *this;
+}
+
+
+ScanCounters ScanCounters::operator-(const ScanCounters &other) const noexcept {
+    return {
+        syscallCount - other.syscallCount,
+        bytesRead - other.bytesRead,
+        bytesWritten - other.bytesWritten,
+        shortReadCount - other.shortReadCount,
+        failedReadCount - other.failedReadCount,
+        failedWriteCount - other.failedWriteCount,
+    };
+}
+
+
+ScanCounters &ThreadScanCounters() noexcept {
+    thread_local ScanCounters counters;
+    return counters;
+}
+
+
+static thread_local ScanStats *currentStats = nullptr;
+
+ScanStats *ScanStats::Current() noexcept {
+    return currentStats;
+}
+
+
+void ScanStats::AddTask(const RegionStats &task, bool isSameRegion) {
+    counters += task.counters;
+    matchCount += task.matchCount;
+    if (isSameRegion && !regions.empty()) {
+        RegionStats &region = regions.back();
+        region.endAddr = task.endAddr;
+        region.counters += task.counters;
+        region.matchCount += task.matchCount;
+        region.nanoseconds += task.nanoseconds;
+        return;
+    }
+    ++regionCount;
+    regions.push_back(task);
+}
+
+
+static void AppendCountersJson(std::string &json, const ScanCounters &counters) {
+    std::format_to(std::back_inserter(json),
+                   R"("syscallCount":{},"bytesRead":{},"bytesWritten":{},"shortReadCount":{},"failedReadCount":{},"failedWriteCount":{})",
+                   counters.syscallCount, counters.bytesRead, counters.bytesWritten, counters.shortReadCount, counters.failedReadCount, counters.failedWriteCount);
+}
+
+
+std::string ScanStats::ToJson() const {
+    std::string json = "{";
+    AppendCountersJson(json, counters);
+    std::format_to(std::back_inserter(json), R"(,"regionCount":{},"matchCount":{},"planNs":{},"scanNs":{},"mergeNs":{},"writeNs":{},"regions":[)",
+                   regionCount, matchCount, planNs, scanNs, mergeNs, writeNs);
+    for (std::size_t i = 0; i < regions.size(); ++i) {
+        const RegionStats &region = regions[i];
+        std::format_to(std::back_inserter(json), R"({}{{"pid":{},"beginAddr":{},"endAddr":{},)", (i == 0) ? "" : ",", region.pid, region.beginAddr, region.endAddr);
+        AppendCountersJson(json, region.counters);
+        std::format_to(std::back_inserter(json), R"(,"matchCount":{},"nanoseconds":{}}})", region.matchCount, region.nanoseconds);
+    }
+    json += "]}";
+    return json;
+}
+
+
+ScanStatsScope::ScanStatsScope(ScanStats &stats) noexcept
+    : _previous{currentStats} {
+    currentStats = &stats;
+}
+
+
+ScanStatsScope::~ScanStatsScope() {
+    currentStats = _previous;
+}
+
+} // namespace ame
@@ -0,0 +1,261 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_string.h"
+#include "ame_logger.h"
+#include "ame_memory.h"
+
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ame {
+
+/**
+ * @brief Decode the next code point of UTF-8 text.
+ * @return The code point, or std::nullopt if the bytes at pos are not valid UTF-8.
+ */
+static std::optional<char32_t> DecodeUtf8(std::string_view text, std::size_t &pos) {
+    const auto lead = std::uint8_t(text[pos]);
+    std::size_t length;
+    char32_t codePoint;
+    if (lead < 0x80) {
+        length = 1;
+        codePoint = lead;
+    } else if ((lead & 0xE0) == 0xC0) {
+        length = 2;
+        codePoint = lead & 0x1F;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3;
+        codePoint = lead & 0x0F;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4;
+        codePoint = lead & 0x07;
+    } else {
+        return std::nullopt;
+    }
+    if (pos + length > text.size()) {
+        return std::nullopt;
+    }
+    for (std::size_t i = 1; i < length; ++i) {
+        const auto trail = std::uint8_t(text[pos + i]);
+        if ((trail & 0xC0) != 0x80) {
+            return std::nullopt;
+        }
+        codePoint = (codePoint << 6) | (trail & 0x3F);
+    }
+    static constexpr char32_t minCodePoint[] = {0, 0, 0x80, 0x800, 0x10000};
+    if ((codePoint < minCodePoint[length]) || (codePoint > 0x10FFFF) || ((codePoint >= 0xD800) && (codePoint <= 0xDFFF))) {
+        return std::nullopt; // overlong, out of range, or a surrogate
+    }
+    pos += length;
+    return codePoint;
+}
+
+
+static bool IsAsciiLetter(std::byte byte) noexcept {
+    const auto c = std::to_integer<std::uint8_t>(byte);
+    return ((c >= 'A') && (c <= 'Z')) || ((c >= 'a') && (c <= 'z'));
+}
+
+
+/**
+ * @brief The bytes of a string to search for, matched at one byte (the anchor) with memchr before comparing the rest.
+ */
+class StringMatcher {
+public:
+    StringMatcher(std::vector<std::byte> bytes, StringEncoding encoding, bool ignoreCase)
+        : _bytes{std::move(bytes)} {
+        const std::size_t unitSize = (encoding == StringEncoding::UTF16LE) ? 2 : 1;
+        _foldMask.assign(_bytes.size(), std::byte{0});
+        if (ignoreCase) {
+            for (std::size_t i = 0; i < _bytes.size(); i += unitSize) {
+                // only ASCII letters fold, not the low byte of another UTF-16 unit
+                if (IsAsciiLetter(_bytes[i]) && ((unitSize == 1) || (_bytes[i + 1] == std::byte{0}))) {
+                    _foldMask[i] = std::byte{0x20};
+                    _bytes[i] |= std::byte{0x20};
+                    _isFolded = true;
+                }
+            }
+        }
+
+        // Prefer an anchor that has one form and is not 0, which is every other byte of ASCII text in UTF-16.
+        for (std::size_t i = 0; i < _bytes.size(); ++i) {
+            if ((_foldMask[i] == std::byte{0}) && (_bytes[i] != std::byte{0})) {
+                _anchorOffset = i;
+                break;
+            }
+        }
+        _anchor = _bytes[_anchorOffset];
+        _altAnchor = _anchor & ~_foldMask[_anchorOffset];
+    }
+
+    [[nodiscard]] std::size_t Size() const noexcept {
+        return _bytes.size();
+    }
+
+    bool operator()(const std::byte *data) const noexcept {
+        if (!_isFolded) {
+            return std::memcmp(data, _bytes.data(), _bytes.size()) == 0;
+        }
+        for (std::size_t i = 0; i < _bytes.size(); ++i) {
+            if ((data[i] | _foldMask[i]) != _bytes[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MatchPiece(std::uint64_t firstAddr, std::span<const std::byte> data, std::size_t count, std::size_t step, AddrChunkList &result) const {
+        // anchors of the addresses firstAddr + i * step, with i in [0, count)
+        const std::byte *searchBegin = data.data() + _anchorOffset;
+        const std::byte *const searchEnd = searchBegin + (count - 1) * step + 1;
+        const std::byte *next = Find(searchBegin, searchEnd, _anchor);
+        const std::byte *nextAlt = (_altAnchor == _anchor) ? searchEnd : Find(searchBegin, searchEnd, _altAnchor);
+        while ((next != searchEnd) || (nextAlt != searchEnd)) {
+            const std::byte *anchorPos;
+            if (next < nextAlt) {
+                anchorPos = next;
+                next = Find(next + 1, searchEnd, _anchor);
+            } else {
+                anchorPos = nextAlt;
+                nextAlt = Find(nextAlt + 1, searchEnd, _altAnchor);
+            }
+            const std::byte *matchPos = anchorPos - _anchorOffset;
+            const auto distance = std::size_t(matchPos - data.data());
+            if ((distance % step == 0) && (*this)(matchPos)) {
+                result.PushBack(firstAddr + distance);
+            }
+        }
+    }
+
+protected:
+    // memchr is vectorized by libc, which makes it the fastest first-byte filter on every architecture.
+    static const std::byte *Find(const std::byte *begin, const std::byte *end, std::byte byte) noexcept {
+        if (begin >= end) {
+            return end;
+        }
+        const void *pos = std::memchr(begin, std::to_integer<int>(byte), std::size_t(end - begin));
+        return (pos != nullptr) ? static_cast<const std::byte *>(pos) : end;
+    }
+
+    std::vector<std::byte> _bytes;    // folded to lower case where _foldMask is 0x20
+    std::vector<std::byte> _foldMask; // 0x20 for bytes of ASCII letters with ignoreCase, or 0
+    bool _isFolded = false;
+    std::size_t _anchorOffset = 0;
+    std::byte _anchor{};
+    std::byte _altAnchor{}; // the upper case form of _anchor, or _anchor
+};
+
+
+static std::optional<StringMatcher> MakeStringMatcher(std::string_view text, StringEncoding encoding, bool ignoreCase) {
+    std::vector<std::byte> bytes = EncodeString(text, encoding);
+    if (bytes.empty()) {
+        LOG_ERROR("Invalid string to find.");
+        return std::nullopt;
+    }
+    return StringMatcher{std::move(bytes), encoding, ignoreCase};
+}
+
+
+static std::size_t StepOf(StringEncoding encoding) noexcept {
+    return (encoding == StringEncoding::UTF16LE) ? sizeof(char16_t) : 1;
+}
+
+
+std::vector<std::byte> EncodeString(std::string_view text, StringEncoding encoding) {
+    std::vector<std::byte> result;
+    if (encoding == StringEncoding::UTF8) {
+        const auto *data = reinterpret_cast<const std::byte *>(text.data());
+        result.assign(data, data + text.size());
+        return result;
+    }
+
+    result.reserve(text.size() * 2);
+    const auto pushUnit = [&result](char16_t unit) {
+        result.push_back(std::byte(unit & 0xFF));
+        result.push_back(std::byte(unit >> 8));
+    };
+    for (std::size_t pos = 0; pos < text.size();) {
+        const std::optional<char32_t> codePoint = DecodeUtf8(text, pos);
+        if (!codePoint.has_value()) {
+            LOG_ERROR("Invalid UTF-8 at byte {}.", pos);
+            return {};
+        }
+        if (*codePoint < 0x10000) {
+            pushUnit(char16_t(*codePoint));
+        } else {
+            const char32_t offset = *codePoint - 0x10000;
+            pushUnit(char16_t(0xD800 + (offset >> 10)));
+            pushUnit(char16_t(0xDC00 + (offset & 0x3FF)));
+        }
+    }
+    return result;
+}
+
+
+PidAddrMap FindStringAddress(const PidList &pids, MemPart memPart, std::string_view text, StringEncoding encoding, bool ignoreCase) {
+    LOG_INFO("Find address by string of ({}) start.", text);
+    const std::optional<StringMatcher> matcher = MakeStringMatcher(text, encoding, ignoreCase);
+    if (!matcher.has_value()) {
+        return {};
+    }
+    PidAddrMap result = ScanProcesses(pids, memPart, matcher->Size(), StepOf(encoding), *matcher);
+    LOG_INFO("Find address end.");
+    return result;
+}
+
+
+AddrList FindStringAddress(pid_t pid, MemPart memPart, std::string_view text, StringEncoding encoding, bool ignoreCase) {
+    return std::move(FindStringAddress(PidList{pid}, memPart, text, encoding, ignoreCase)[pid]);
+}
+
+
+PidAddrMap FilterStringAddress(const PidAddrMap &mapToFilter, std::string_view text, StringEncoding encoding, bool ignoreCase) {
+    LOG_INFO("Filter address by string of ({}) start.", text);
+    const std::optional<StringMatcher> matcher = MakeStringMatcher(text, encoding, ignoreCase);
+    if (!matcher.has_value()) {
+        return {};
+    }
+    PidAddrMap result = FilterPidAddrMap(mapToFilter, matcher->Size(), 0, *matcher);
+    LOG_INFO("Filter address end.");
+    return result;
+}
+
+
+AddrList FilterStringAddress(pid_t pid, const AddrList &listToFilter, std::string_view text, StringEncoding encoding, bool ignoreCase) {
+    LOG_INFO("Filter address by string of ({}) start.", text);
+    const std::optional<StringMatcher> matcher = MakeStringMatcher(text, encoding, ignoreCase);
+    if (!matcher.has_value()) {
+        return {};
+    }
+    AddrList result = FilterProcess(pid, listToFilter, matcher->Size(), 0, *matcher);
+    LOG_INFO("Filter address end.");
+    return result;
+}
+
+} // namespace ame
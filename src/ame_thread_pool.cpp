@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+namespace ame {
+
+ThreadPool::ThreadPool(std::size_t threadCount) {
+    _workers.reserve(threadCount);
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        _workers.emplace_back([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+    }
+}
+
+
+ThreadPool::~ThreadPool() {
+    for (auto &worker : _workers) {
+        worker.request_stop();
+    }
+    _jobCond.notify_all();
+    _workers.clear(); // join
+}
+
+
+void ThreadPool::ParallelFor(std::size_t count, const std::function<void(std::size_t)> &func) {
+    if (count == 0) {
+        return;
+    }
+
+    // Shared with helper jobs, which may outlive this call if they start after all indices are taken.
+    struct State {
+        std::atomic_size_t nextIndex = 0;
+        std::size_t doneCount = 0;
+        std::mutex mutex;
+        std::condition_variable doneCond;
+    };
+    const auto state = std::make_shared<State>();
+    const std::size_t total = count;
+
+    // func is only called for a taken index, and this call does not return until every taken index is done.
+    auto runIndices = [state, total, &func] {
+        std::size_t localDone = 0;
+        for (std::size_t i; (i = state->nextIndex.fetch_add(1, std::memory_order_relaxed)) < total;) {
+            func(i);
+            ++localDone;
+        }
+        if (localDone != 0) {
+            const std::lock_guard lock{state->mutex};
+            state->doneCount += localDone;
+            if (state->doneCount == total) {
+                state->doneCond.notify_all();
+            }
+        }
+    };
+
+    const std::size_t helperCount = std::min(count - 1, ThreadCount());
+    for (std::size_t i = 0; i < helperCount; ++i) {
+        Post(runIndices);
+    }
+    runIndices();
+
+    std::unique_lock lock{state->mutex};
+    state->doneCond.wait(lock, [&state, total] { return state->doneCount == total; });
+}
+
+
+void ThreadPool::Post(std::function<void()> job) {
+    {
+        const std::lock_guard lock{_mutex};
+        _jobs.push_back(std::move(job));
+    }
+    _jobCond.notify_one();
+}
+
+
+void ThreadPool::WorkerLoop(std::stop_token stopToken) {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock{_mutex};
+            if (!_jobCond.wait(lock, stopToken, [this] { return !_jobs.empty(); })) {
+                return; // stop requested
+            }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
+
+} // namespace ame
@@ -51,8 +51,10 @@ int main(int argc, char* argv[]) {
             std::println("New package name: '{}'", packageName);
 
         } else if (option == "2") {
-            if (auto pidOpt = FindPidByProcessName(packageName); pidOpt.has_value()) {
-                std::println("PID of '{}': {}", packageName, *pidOpt);
+            if (const auto pids = FindPidsByProcessName(packageName); !pids.empty()) {
+                for (const pid_t pid : pids) {
+                    std::println("PID of '{}': {}", packageName, pid);
+                }
             } else {
                 std::println("PID of '{}' not find.", packageName);
             }
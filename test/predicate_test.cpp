@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024, 2025  Dicot0721
+ *
+ * This file is part of Android-Memory-Editor.
+ *
+ * Android-Memory-Editor is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * Android-Memory-Editor is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * Android-Memory-Editor.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ame_predicate.h"
+
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <print>
+#include <string_view>
+
+static int failureCount = 0;
+
+static void Check(bool condition, std::string_view what) {
+    if (!condition) {
+        std::println(stderr, "FAILED: {}", what);
+        ++failureCount;
+    }
+}
+
+/**
+ * @brief Malformed expressions are rejected, without reading a missing operand.
+ */
+static void TestInvalidExpressions() {
+    for (const std::string_view expression : {"", "!", "&&", "|| 1", "! && 1", "value &&", "value || !", "(value", "value ==== 3", "value +"}) {
+        Check(!ame::ParsePredicate(expression).has_value(), expression);
+    }
+}
+
+static void TestValidExpressions() {
+    const auto kernel = ame::CompilePredicate<std::int32_t>("(value != 0) && (value % 10 == 0)");
+    Check(kernel.has_value(), "compile");
+    if (kernel.has_value()) {
+        Check((*kernel)(20) && !(*kernel)(0) && !(*kernel)(21), "(value != 0) && (value % 10 == 0)");
+    }
+    const auto bare = ame::CompilePredicate<std::int32_t>("value & 1");
+    Check(bare.has_value() && (*bare)(3) && !(*bare)(4), "value & 1");
+}
+
+/**
+ * @brief An expression built at compile time and the same text compiled at runtime agree on values of T, including
+ * where they overflow or divide by 0.
+ */
+template <ame::Arithmetic T, typename Expr>
+static void CheckSameResult(const Expr &expr, std::string_view expression) {
+    const auto kernel = ame::CompilePredicate<T>(expression);
+    Check(kernel.has_value(), expression);
+    if (!kernel.has_value()) {
+        return;
+    }
+    using Limits = std::numeric_limits<T>;
+    for (const T value : {T(0), T(1), T(2), T(3), T(-1), T(10), T(100), Limits::max(), Limits::lowest(), T(Limits::max() / 2 + 1)}) {
+        if (expr(value) != (*kernel)(value)) {
+            Check(false, std::format("{} for {} of {}", expression, value, sizeof(T)));
+        }
+    }
+}
+
+template <ame::Arithmetic T>
+static void TestIntegerExpressions() {
+    using ame::predicate::value;
+    CheckSameResult<T>(value * 3 + 7 == 10, "value * 3 + 7 == 10");
+    CheckSameResult<T>(value * value < 0, "value * value < 0");
+    CheckSameResult<T>(value + 1 < value, "value + 1 < value");
+    CheckSameResult<T>(-value == value, "-value == value");
+    CheckSameResult<T>(100 / value == 0, "100 / value == 0");
+    CheckSameResult<T>(value / (value - 1) == 0, "value / (value - 1) == 0");
+    CheckSameResult<T>(value % (value - 1) == 0, "value % (value - 1) == 0");
+    CheckSameResult<T>((value << 4) >> 4 == value, "(value << 4) >> 4 == value");
+    CheckSameResult<T>((value != 0) && (100 % value == 0), "(value != 0) && (100 % value == 0)");
+    CheckSameResult<T>((value == 0) || (value / value == 1), "(value == 0) || (value / value == 1)");
+    CheckSameResult<T>(!(value & 1) && (~value != 0), "!(value & 1) && (~value != 0)");
+}
+
+static void TestFloatExpressions() {
+    using ame::predicate::value;
+    CheckSameResult<float>(value * 2 > 5, "value * 2 > 5");
+    CheckSameResult<double>((value / 0 > 1) || (value == 0), "(value / 0 > 1) || (value == 0)");
+    CheckSameResult<double>(value % 3 == 1, "value % 3 == 1");
+}
+
+int main() {
+    ame::Logger::Instance().SetLevel(ame::LogLevel::OFF);
+    TestInvalidExpressions();
+    TestValidExpressions();
+    TestIntegerExpressions<std::int8_t>();
+    TestIntegerExpressions<std::uint16_t>();
+    TestIntegerExpressions<std::int16_t>();
+    TestIntegerExpressions<std::int32_t>();
+    TestIntegerExpressions<std::uint32_t>();
+    TestIntegerExpressions<std::int64_t>();
+    TestFloatExpressions();
+    if (failureCount != 0) {
+        std::println(stderr, "{} checks failed.", failureCount);
+        return 1;
+    }
+    std::println("All checks passed.");
+    return 0;
+}